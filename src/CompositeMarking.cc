@@ -22,6 +22,7 @@
 #include "LivelockOperatingGuideline.h"
 #include "Label.h"
 #include "Clause.h"
+#include "Statistics.h"
 #include "util.h"
 
 
@@ -38,10 +39,8 @@
 */
 CompositeMarking::CompositeMarking(const StoredKnowledge* _storedKnowledge,
                                    const InnerMarking_ID _innerMarking_ID,
-                                   InterfaceMarking* _interface) : dfs(0), lowlink(0), storedKnowledge(_storedKnowledge), interface(_interface), innerMarking_ID(_innerMarking_ID)
-
-{
-
+                                   InterfaceMarking* _interface) : dfs(0), lowlink(0), storedKnowledge(_storedKnowledge), interface(_interface), innerMarking_ID(_innerMarking_ID) {
+    Statistics::created(Statistics::COMPOSITE_MARKING);
 }
 
 
@@ -69,8 +68,8 @@ void CompositeMarking::getMyFormula(Clause* booleanClause, bool& emptyClause) {
     for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
         // receiving event resolves deadlock
         if (interface->marked(l) and
-                storedKnowledge->successors[l - 1] != NULL and storedKnowledge->successors[l - 1] != StoredKnowledge::empty and
-                storedKnowledge->successors[l - 1]->is_sane) {
+                storedKnowledge->successor(l) != NULL and storedKnowledge->successor(l) != StoredKnowledge::empty and
+                storedKnowledge->successor(l)->is_sane) {
 
             emptyClause = false;
 
@@ -81,9 +80,9 @@ void CompositeMarking::getMyFormula(Clause* booleanClause, bool& emptyClause) {
     // synchronous communication
     for (Label_ID l = Label::first_sync; l <= Label::last_sync; ++l) {
         // synchronous communication resolves deadlock
-        if (InnerMarking::synchs[l].find(innerMarking_ID) != InnerMarking::synchs[l].end() and
-                storedKnowledge->successors[l - 1] != NULL and storedKnowledge->successors[l - 1] != StoredKnowledge::empty and
-                storedKnowledge->successors[l - 1]->is_sane) {
+        if (InnerMarking::activatedBy(innerMarking_ID, l) and
+                storedKnowledge->successor(l) != NULL and storedKnowledge->successor(l) != StoredKnowledge::empty and
+                storedKnowledge->successor(l)->is_sane) {
 
             emptyClause = false;
 
@@ -93,7 +92,7 @@ void CompositeMarking::getMyFormula(Clause* booleanClause, bool& emptyClause) {
 
     // collect outgoing !-edges
     for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-        if (storedKnowledge->successors[l - 1] != NULL and storedKnowledge->successors[l - 1]->is_sane) {
+        if (storedKnowledge->successor(l) != NULL and storedKnowledge->successor(l)->is_sane) {
 
             emptyClause = false;
 
@@ -102,7 +101,7 @@ void CompositeMarking::getMyFormula(Clause* booleanClause, bool& emptyClause) {
     }
 
     // this marking is final
-    if (interface->unmarked() and InnerMarking::inner_markings[innerMarking_ID]->is_final) {
+    if (interface->unmarked() and InnerMarking::isFinal(innerMarking_ID)) {
         booleanClause->addFinalKnowledge(storedKnowledge);
         emptyClause = false;
     }
@@ -118,6 +117,26 @@ bool CompositeMarking::operator== (const CompositeMarking& other) const {
     return true;
 }
 
+/*!
+  \note The hash value combines the hash value of the interface with the
+        inner marking and the address of the knowledge. It is only used to
+        find visited markings, so it need not be the same in every run.
+*/
+hash_t CompositeMarking::hash(const StoredKnowledge* _storedKnowledge,
+                              const InnerMarking_ID _innerMarking_ID,
+                              const InterfaceMarking* _interface) {
+    hash_t result = _interface->hash();
+    result = (result ^ _innerMarking_ID) * 1099511628211ULL;
+    result = (result ^ reinterpret_cast<size_t>(_storedKnowledge)) * 1099511628211ULL;
+
+    // the multiplications only move information to the upper bits
+    return result ^ (result >> 32);
+}
+
+hash_t CompositeMarking::hash() const {
+    return hash(storedKnowledge, innerMarking_ID, interface);
+}
+
 std::ostream& operator<< (std::ostream& o, const CompositeMarking& m) {
     o << "[";
     o << reinterpret_cast<size_t>(m.storedKnowledge);
@@ -135,6 +154,7 @@ std::ostream& operator<< (std::ostream& o, const CompositeMarking& m) {
  ******************/
 
 CompositeMarking** CompositeMarkingsHandler::visitedCompositeMarkings = NULL;
+std::vector<CompositeMarking* > CompositeMarkingsHandler::visitedTable;
 std::vector<CompositeMarking* > CompositeMarkingsHandler::tarjanStack;
 unsigned int CompositeMarkingsHandler::numberElements = 0;
 unsigned int CompositeMarkingsHandler::maxSize = 0;
@@ -148,7 +168,7 @@ std::vector<Clause* > CompositeMarkingsHandler::conjunctionOfDisjunctionsBoolean
 
 /*!
   checks if the given marking has been visited already, if so return a pointer to the marking otherwise return the new marking
-  Note: in case the marking has been found, you may need to delete the given marking afterwards
+  Note: in case the marking has been found, the given interface is deleted
   \param _storedKnowledge the knowledge of the new marking
   \param _innerMarking_ID the inner marking of the new marking
   \param _interface the interface of the new marking
@@ -156,43 +176,61 @@ std::vector<Clause* > CompositeMarkingsHandler::conjunctionOfDisjunctionsBoolean
 
   \return pointer to the new marking or the marking that has been visited already but equals to the one given
 
-  \todo Niels thinks the for loop can be simplified
+  \note The visited markings are looked up in a hash table, so a composite
+        marking is only created if it has not been visited yet.
 */
 CompositeMarking* CompositeMarkingsHandler::isVisited(const StoredKnowledge* _storedKnowledge,
                                                       const InnerMarking_ID _innerMarking_ID,
                                                       InterfaceMarking* _interface,
                                                       bool& foundMarking) {
 
-    // create new marking
-    CompositeMarking* newMarking = new CompositeMarking(_storedKnowledge, _innerMarking_ID, _interface);
-    foundMarking = false;
+    CompositeMarking* storedMarking = find(_storedKnowledge, _innerMarking_ID, _interface);
+
+    // we have seen the "new" marking already, so return the old one and delete the given interface
+    if (storedMarking != NULL) {
+        foundMarking = true;
+
+        delete _interface;
 
-    // we have not yet seen any marking, so return the newly created one
-    if (numberElements == 0) {
-        return newMarking;
+        return storedMarking;
     }
 
-    CompositeMarking* storedMarking;
+    // return a newly created marking
+    foundMarking = false;
+    return new CompositeMarking(_storedKnowledge, _innerMarking_ID, _interface);
+}
 
-    // iterate through all visited markings
-    for (unsigned int i = 0; i < numberElements; ++i) {
-        storedMarking = visitedCompositeMarkings[i];
 
-        assert(storedMarking != NULL);
+/*!
+  \param _storedKnowledge the knowledge of the marking
+  \param _innerMarking_ID the inner marking of the marking
+  \param _interface the interface of the marking
+
+  \return the visited composite marking with the given components or NULL if
+          no such marking has been visited yet
+*/
+CompositeMarking* CompositeMarkingsHandler::find(const StoredKnowledge* _storedKnowledge,
+                                                 const InnerMarking_ID _innerMarking_ID,
+                                                 const InterfaceMarking* _interface) {
 
-        // we have seen the "new" marking already, so return the old one and delete the new one
-        if (*newMarking == *storedMarking) {
+    assert(not visitedTable.empty());
 
-            foundMarking = true;
+    const size_t mask = visitedTable.size() - 1;
+    size_t slot = CompositeMarking::hash(_storedKnowledge, _innerMarking_ID, _interface) & mask;
 
-            delete newMarking;
+    while (visitedTable[slot] != NULL) {
+        CompositeMarking* storedMarking = visitedTable[slot];
 
+        if (storedMarking->storedKnowledge == _storedKnowledge and
+                storedMarking->innerMarking_ID == _innerMarking_ID and
+                *storedMarking->interface == *_interface) {
             return storedMarking;
         }
+
+        slot = (slot + 1) & mask;
     }
 
-    // return the newly created marking
-    return newMarking;
+    return NULL;
 }
 
 
@@ -207,6 +245,14 @@ void CompositeMarkingsHandler::visitMarking(CompositeMarking* marking) {
 
     visitedCompositeMarkings[numberElements++] = marking;
 
+    // insert the marking into the hash table
+    const size_t mask = visitedTable.size() - 1;
+    size_t slot = marking->hash() & mask;
+    while (visitedTable[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    visitedTable[slot] = marking;
+
     // set Tarjan values
     marking->dfs = marking->lowlink = numberElements;
 }
@@ -263,6 +309,14 @@ void CompositeMarkingsHandler::initialize(const std::set<StoredKnowledge* > & se
     }
 
     visitedCompositeMarkings = new CompositeMarking*[maxSize];
+
+    // at most maxSize markings are visited, so a hash table with a load
+    // factor below 1/2 never needs to grow
+    size_t tableSize = 16;
+    while (tableSize < 2 * static_cast<size_t>(maxSize)) {
+        tableSize *= 2;
+    }
+    visitedTable.assign(tableSize, NULL);
 }
 
 
@@ -277,6 +331,7 @@ void CompositeMarkingsHandler::finalize() {
     }
 
     delete [] visitedCompositeMarkings;
+    std::vector<CompositeMarking* >().swap(visitedTable);
 
     numberElements = 0;
 
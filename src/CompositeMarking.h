@@ -52,6 +52,14 @@ class CompositeMarking {
         /// compare two composite markings
         bool operator== (const CompositeMarking& other) const ;
 
+        /// returns the hash value of the composite marking
+        hash_t hash() const;
+
+        /// returns the hash value of the composite marking given by its components
+        static hash_t hash(const StoredKnowledge* _storedKnowledge,
+                           const InnerMarking_ID _innerMarking_ID,
+                           const InterfaceMarking* _interface);
+
         /// stream output operator
         friend std::ostream& operator<< (std::ostream&, const CompositeMarking&);
 
@@ -90,6 +98,11 @@ class CompositeMarkingsHandler {
                                            InterfaceMarking* _interface,
                                            bool& foundMarking);
 
+        /// returns the visited marking given by its components (or NULL)
+        static CompositeMarking* find(const StoredKnowledge* _storedKnowledge,
+                                      const InnerMarking_ID _innerMarking_ID,
+                                      const InterfaceMarking* _interface);
+
         /// stores given marking in the set of visited markings
         static void visitMarking(CompositeMarking* marking);
 
@@ -107,6 +120,9 @@ class CompositeMarkingsHandler {
         /// an array storing all composite markings we have visited so far
         static CompositeMarking** visitedCompositeMarkings;
 
+        /// a hash table (open addressing) of the visited composite markings
+        static std::vector<CompositeMarking* > visitedTable;
+
         /// stack of composite markings used for Tarjan algorithm
         static std::vector<CompositeMarking* > tarjanStack;
 
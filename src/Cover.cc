@@ -232,7 +232,7 @@ void Cover::clear() {
  *
  */
 void Cover::checkKnowledge(StoredKnowledge* K,
-                           const std::map<InnerMarking_ID, std::vector<InterfaceMarking*> > & bubble) {
+                           const Bubble& bubble) {
     /*
      * Sets for node collection in order to avoid dublicates.
      * Order is:
@@ -246,29 +246,26 @@ void Cover::checkKnowledge(StoredKnowledge* K,
     /// iterate through the knowledge bubble
     FOREACH(current, bubble) {
         /// copy internal places
-        for (unsigned int i = 0; i < inner2CD[current->first].inP.size(); ++i) {
-            coveredNodes[0].insert(inner2CD[current->first].inP[i]);
+        for (unsigned int i = 0; i < inner2CD[current->inner].inP.size(); ++i) {
+            coveredNodes[0].insert(inner2CD[current->inner].inP[i]);
         }
 
         /// copy internal transitions
-        for (unsigned int i = 0; i < inner2CD[current->first].inT.size(); ++i) {
-            coveredNodes[2].insert(inner2CD[current->first].inT[i]);
+        for (unsigned int i = 0; i < inner2CD[current->inner].inT.size(); ++i) {
+            coveredNodes[2].insert(inner2CD[current->inner].inT[i]);
         }
 
-        /// check interface markings
-        for (unsigned int i = 0; i < current->second.size(); ++i) {
-            /// check interface places
-            for (unsigned int j = 0; j < interfacePlaceCount; ++j) {
-                if (current->second[i]->marked(interfacePlaceLabels[j])) {
-                    coveredNodes[1].insert(j);
-                }
+        /// check interface places
+        for (unsigned int j = 0; j < interfacePlaceCount; ++j) {
+            if (current->interface->marked(interfacePlaceLabels[j])) {
+                coveredNodes[1].insert(j);
             }
+        }
 
-            /// check interface transitions
-            for (unsigned int j = 0; j < inner2CD[current->first].comT.size(); ++j) {
-                if (current->second[i]->marked(Label::name2id[interfaceTransitions[inner2CD[current->first].comT[j]]])) {
-                    coveredNodes[3].insert(inner2CD[current->first].comT[j]);
-                }
+        /// check interface transitions
+        for (unsigned int j = 0; j < inner2CD[current->inner].comT.size(); ++j) {
+            if (current->interface->marked(Label::name2id[interfaceTransitions[inner2CD[current->inner].comT[j]]])) {
+                coveredNodes[3].insert(inner2CD[current->inner].comT[j]);
             }
         }
     }
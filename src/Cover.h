@@ -111,7 +111,7 @@ class Cover {
         static void clear();
 
         /// checks for a given knowledge, which nodes are covered
-        static void checkKnowledge(StoredKnowledge*, const std::map<InnerMarking_ID, std::vector<InterfaceMarking*> > &);
+        static void checkKnowledge(StoredKnowledge*, const Bubble&);
 
         /// removes knowledges when deleted
         static void removeKnowledge(StoredKnowledge*);
@@ -110,129 +110,129 @@ void Diagnosis::output_results(Results& r) {
     std::stringstream temp;
 
     temp << "  states = (\n";
+    bool firstState = true;
 
-    FOREACH(it, StoredKnowledge::hashTree) {
-        for (size_t i = 0; i < it->second.size(); ++i) {
-            if (StoredKnowledge::seen.find(it->second[i]) != StoredKnowledge::seen.end()) {
+    for (size_t i = 0; i < StoredKnowledge::knowledgeTable.capacity(); ++i) {
+        StoredKnowledge* const SK = StoredKnowledge::knowledgeTable[i];
 
-                if (it != StoredKnowledge::hashTree.begin() or i != 0) {
-                    temp << ",\n";
-                }
+        if (SK != NULL and StoredKnowledge::seen.find(SK) != StoredKnowledge::seen.end()) {
+            if (not firstState) {
+                temp << ",\n";
+            }
+            firstState = false;
 
-                temp << "    { id = " << reinterpret_cast<size_t>(it->second[i]) << ";\n";
+            temp << "    { id = " << reinterpret_cast<size_t>(SK) << ";\n";
 
-                // the current diagnosis object as container for the knowledge
-                DiagnosisObject current;
+            // the current diagnosis object as container for the knowledge
+            DiagnosisObject current;
 
 
-                // collect possible send events for the waitstates
-                PossibleSendEvents p = PossibleSendEvents(true, 1);
-                for (unsigned int j = 0; j < it->second[i]->sizeDeadlockMarkings; ++j) {
-                    p &= *InnerMarking::inner_markings[it->second[i]->inner[j]]->possibleSendEvents;
-                }
+            // collect possible send events for the waitstates
+            PossibleSendEvents p(true, 1);
+            for (unsigned int j = 0; j < SK->sizeDeadlockMarkings; ++j) {
+                p &= InnerMarking::sendEvents(SK->inner[j]);
+            }
 
 
-                set<InnerMarking_ID> hiddenStates;
-                for (unsigned int j = 0; j < it->second[i]->sizeAllMarkings; ++j) {
-                    bool inner_waitstate = (j < it->second[i]->sizeDeadlockMarkings);
-                    bool inner_final = InnerMarking::inner_markings[it->second[i]->inner[j]]->is_final;
-                    bool inner_dead = InnerMarking::inner_markings[it->second[i]->inner[j]]->is_bad;
-                    bool interface_empty = it->second[i]->interface[j]->unmarked();
-                    bool interface_sane = it->second[i]->interface[j]->sane();
-                    bool interface_pendingOutput = it->second[i]->interface[j]->pendingOutput();
-
-
-                    /*****************************************
-                    * check if there is an internal livelock *
-                    *****************************************/
-                    bool livelock = true;
-                    FOREACH(m, markings2scc[it->second[i]->inner[j]]) {
-                        if (InnerMarking::inner_markings[*m]->is_final) {
-                            livelock = false;
-                            return;
-                        }
+            set<InnerMarking_ID> hiddenStates;
+            for (unsigned int j = 0; j < SK->sizeAllMarkings; ++j) {
+                bool inner_waitstate = (j < SK->sizeDeadlockMarkings);
+                bool inner_final = InnerMarking::isFinal(SK->inner[j]);
+                bool inner_dead = InnerMarking::isBad(SK->inner[j]);
+                bool interface_empty = SK->interface[j].unmarked();
+                bool interface_sane = SK->interface[j].sane();
+                bool interface_pendingOutput = SK->interface[j].pendingOutput();
+
+
+                /*****************************************
+                * check if there is an internal livelock *
+                *****************************************/
+                bool livelock = true;
+                FOREACH(m, markings2scc[SK->inner[j]]) {
+                    if (InnerMarking::isFinal(*m)) {
+                        livelock = false;
+                        return;
                     }
+                }
 
-                    if (livelock and not markings2scc[it->second[i]->inner[j]].empty()) {
-                        // project the current livelock to actually present
-                        set<InnerMarking_ID> ll;
+                if (livelock and not markings2scc[SK->inner[j]].empty()) {
+                    // project the current livelock to actually present
+                    set<InnerMarking_ID> ll;
 
-                        // traverse this node's states
-                        for (unsigned int k = 0; k < it->second[i]->sizeAllMarkings; ++k) {
-                            if (markings2scc[it->second[i]->inner[j]].find(it->second[i]->inner[k]) != markings2scc[it->second[i]->inner[j]].end()) {
-                                ll.insert(it->second[i]->inner[k]);
-                            }
+                    // traverse this node's states
+                    for (unsigned int k = 0; k < SK->sizeAllMarkings; ++k) {
+                        if (markings2scc[SK->inner[j]].find(SK->inner[k]) != markings2scc[SK->inner[j]].end()) {
+                            ll.insert(SK->inner[k]);
                         }
-                        current.internalLivelocks.insert(ll);
                     }
+                    current.internalLivelocks.insert(ll);
+                }
 
 
-                    /*****************************************
-                    * check if there is an internal deadlock *
-                    *****************************************/
-                    if (inner_dead) {
-                        current.internalDeadlocks.insert(it->second[i]->inner[j]);
-                    }
+                /*****************************************
+                * check if there is an internal deadlock *
+                *****************************************/
+                if (inner_dead) {
+                    current.internalDeadlocks.insert(SK->inner[j]);
+                }
 
 
-                    /**********************************************
-                    * check if there is a message bound violation *
-                    **********************************************/
-                    if (not interface_sane) {
-                        for (Label_ID l = Label::first_receive; l <= Label::last_send; ++l) {
-                            if (it->second[i]->interface[j]->get(l) > InterfaceMarking::message_bound) {
-                                current.violatedChannels.insert(l);
-                            }
+                /**********************************************
+                * check if there is a message bound violation *
+                **********************************************/
+                if (not interface_sane) {
+                    for (Label_ID l = Label::first_receive; l <= Label::last_send; ++l) {
+                        if (SK->interface[j].get(l) > InterfaceMarking::message_bound) {
+                            current.violatedChannels.insert(l);
                         }
                     }
+                }
 
-                    if (inner_final and interface_empty) {
+                if (inner_final and interface_empty) {
 //                            file << " <FONT COLOR=\"GREEN\">(f)</FONT>";
-                    } else {
-                        if (inner_waitstate and not interface_pendingOutput) {
-                            // check who can resolve this waitstate
-                            vector<Label_ID> resolvers, disallowedResolvers;
-                            for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-                                if (InnerMarking::receivers[l].find(it->second[i]->inner[j]) != InnerMarking::receivers[l].end()) {
-                                    resolvers.push_back(l);
-                                }
+                } else {
+                    if (inner_waitstate and not interface_pendingOutput) {
+                        // check who can resolve this waitstate
+                        vector<Label_ID> resolvers, disallowedResolvers;
+                        for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
+                            if (InnerMarking::activatedBy(SK->inner[j], l)) {
+                                resolvers.push_back(l);
                             }
+                        }
 
-                            for (unsigned int l = 0; l < resolvers.size(); ++l) {
-                                char* a = p.decode();
-                                if (a[resolvers[l] - Label::first_send] == 0) {
-                                    disallowedResolvers.push_back(resolvers[l]);
-                                }
-                            }
-                            if (disallowedResolvers.size() == resolvers.size()) {
-                                current.unresolvableWaitstates.insert(it->second[i]->inner[j]);
-//                                hiddenStates.insert(it->second[i]->inner[j]);
+                        for (unsigned int l = 0; l < resolvers.size(); ++l) {
+                            if (not p.possible(resolvers[l])) {
+                                disallowedResolvers.push_back(resolvers[l]);
                             }
                         }
+                        if (disallowedResolvers.size() == resolvers.size()) {
+                            current.unresolvableWaitstates.insert(SK->inner[j]);
+//                                hiddenStates.insert(SK->inner[j]);
+                        }
                     }
                 }
+            }
 
 
-                temp << current.output_results();
+            temp << current.output_results();
 
 
-                bool firstSuccessor = true;
-                temp << "      successors = (";
-                // draw the edges
-                for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-                    if (it->second[i]->successors[l - 1] != NULL and
-                            (StoredKnowledge::seen.find(it->second[i]->successors[l - 1]) != StoredKnowledge::seen.end())) {
+            bool firstSuccessor = true;
+            temp << "      successors = (";
+            // draw the edges
+            for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
+                if (SK->successor(l) != NULL and
+                        (StoredKnowledge::seen.find(SK->successor(l)) != StoredKnowledge::seen.end())) {
 
-                        if (not firstSuccessor) {
-                            temp << ", ";
-                        }
-                        temp << "(\"" << Label::id2name[l] << "\", "
-                             << reinterpret_cast<size_t>(it->second[i]->successors[l - 1]) << ")";
-                        firstSuccessor = false;
+                    if (not firstSuccessor) {
+                        temp << ", ";
                     }
+                    temp << "(\"" << Label::id2name[l] << "\", "
+                         << reinterpret_cast<size_t>(SK->successor(l)) << ")";
+                    firstSuccessor = false;
                 }
-                temp << "); }";
             }
+            temp << "); }";
         }
     }
 
@@ -254,114 +254,113 @@ void Diagnosis::output_diagnosedot(std::ostream& file) {
          << " edge [fontname=\"Helvetica\" fontsize=10]\n";
 
     // draw the nodes
-    FOREACH(it, StoredKnowledge::hashTree) {
-        for (size_t i = 0; i < it->second.size(); ++i) {
-            if (StoredKnowledge::seen.find(it->second[i]) != StoredKnowledge::seen.end()) {
-                file << "\"" << it->second[i] << "\" [label=<" << it->second[i] << "<BR/>";
+    for (size_t i = 0; i < StoredKnowledge::knowledgeTable.capacity(); ++i) {
+        StoredKnowledge* const SK = StoredKnowledge::knowledgeTable[i];
 
-                bool blacklisted = false;
+        if (SK != NULL and StoredKnowledge::seen.find(SK) != StoredKnowledge::seen.end()) {
+            file << "\"" << SK << "\" [label=<" << SK << "<BR/>";
 
-                // collect possible send events for the waitstates
-                PossibleSendEvents p = PossibleSendEvents(true, 1);
-                for (unsigned int j = 0; j < it->second[i]->sizeDeadlockMarkings; ++j) {
-                    p &= *InnerMarking::inner_markings[it->second[i]->inner[j]]->possibleSendEvents;
-                }
+            bool blacklisted = false;
 
-                set<InnerMarking_ID> hiddenStates;
-                for (unsigned int j = 0; j < it->second[i]->sizeAllMarkings; ++j) {
-                    bool inner_waitstate = (j < it->second[i]->sizeDeadlockMarkings);
-                    bool inner_final = InnerMarking::inner_markings[it->second[i]->inner[j]]->is_final;
-                    bool inner_dead = InnerMarking::inner_markings[it->second[i]->inner[j]]->is_bad;
-                    bool interface_empty = it->second[i]->interface[j]->unmarked();
-                    bool interface_sane = it->second[i]->interface[j]->sane();
-                    bool interface_pendingOutput = it->second[i]->interface[j]->pendingOutput();
+            // collect possible send events for the waitstates
+            PossibleSendEvents p(true, 1);
+            for (unsigned int j = 0; j < SK->sizeDeadlockMarkings; ++j) {
+                p &= InnerMarking::sendEvents(SK->inner[j]);
+            }
 
-                    file << "m" << static_cast<size_t>(it->second[i]->inner[j]) << " ";
-                    file << *(it->second[i]->interface[j]);
+            set<InnerMarking_ID> hiddenStates;
+            for (unsigned int j = 0; j < SK->sizeAllMarkings; ++j) {
+                bool inner_waitstate = (j < SK->sizeDeadlockMarkings);
+                bool inner_final = InnerMarking::isFinal(SK->inner[j]);
+                bool inner_dead = InnerMarking::isBad(SK->inner[j]);
+                bool interface_empty = SK->interface[j].unmarked();
+                bool interface_sane = SK->interface[j].sane();
+                bool interface_pendingOutput = SK->interface[j].pendingOutput();
 
-                    string reason;
+                file << "m" << static_cast<size_t>(SK->inner[j]) << " ";
+                file << SK->interface[j];
 
-                    if (inner_dead) {
-                        reason += " (dl)";
-                        message("node %p is blacklisted: m%u is internal deadlock",
-                                it->second[i], static_cast<size_t>(it->second[i]->inner[j]));
-                    }
-                    if (not interface_sane) {
-                        reason += " (mb)";
-                        for (Label_ID l = Label::first_receive; l <= Label::last_send; ++l) {
-                            if (it->second[i]->interface[j]->get(l) > InterfaceMarking::message_bound) {
-                                message("node %p is blacklisted: message bound violation on channel %s",
-                                        it->second[i], Label::id2name[l].c_str());
-                            }
+                string reason;
+
+                if (inner_dead) {
+                    reason += " (dl)";
+                    message("node %p is blacklisted: m%u is internal deadlock",
+                            SK, static_cast<size_t>(SK->inner[j]));
+                }
+                if (not interface_sane) {
+                    reason += " (mb)";
+                    for (Label_ID l = Label::first_receive; l <= Label::last_send; ++l) {
+                        if (SK->interface[j].get(l) > InterfaceMarking::message_bound) {
+                            message("node %p is blacklisted: message bound violation on channel %s",
+                                    SK, Label::id2name[l].c_str());
                         }
                     }
+                }
 
-                    if (not reason.empty()) {
-                        blacklisted = true;
-                        file << " <FONT COLOR=\"RED\">" << reason << "</FONT>";
+                if (not reason.empty()) {
+                    blacklisted = true;
+                    file << " <FONT COLOR=\"RED\">" << reason << "</FONT>";
+                } else {
+                    if (inner_final and interface_empty) {
+                        file << " <FONT COLOR=\"GREEN\">(f)</FONT>";
                     } else {
-                        if (inner_final and interface_empty) {
-                            file << " <FONT COLOR=\"GREEN\">(f)</FONT>";
-                        } else {
-                            if (inner_waitstate and not interface_pendingOutput) {
-                                // check who can resolve this waitstate
-                                vector<Label_ID> resolvers, disallowedResolvers;
-                                for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-                                    if (InnerMarking::receivers[l].find(it->second[i]->inner[j]) != InnerMarking::receivers[l].end()) {
-                                        resolvers.push_back(l);
-                                    }
+                        if (inner_waitstate and not interface_pendingOutput) {
+                            // check who can resolve this waitstate
+                            vector<Label_ID> resolvers, disallowedResolvers;
+                            for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
+                                if (InnerMarking::activatedBy(SK->inner[j], l)) {
+                                    resolvers.push_back(l);
                                 }
+                            }
 
-                                for (unsigned int l = 0; l < resolvers.size(); ++l) {
-                                    char* a = p.decode();
-                                    if (a[resolvers[l] - Label::first_send] == 0) {
-                                        disallowedResolvers.push_back(resolvers[l]);
-                                    }
-                                }
-                                if (disallowedResolvers.size() == resolvers.size()) {
-                                    blacklisted = true;
-                                    file << " <FONT COLOR=\"RED\">(uw)</FONT>";
-                                    message("node %p is blacklisted: m%u cannot be safely resolved",
-                                            it->second[i], static_cast<size_t>(it->second[i]->inner[j]));
-                                    hiddenStates.insert(it->second[i]->inner[j]);
-                                } else {
-                                    file << " <FONT COLOR=\"ORANGE\">(w)</FONT>";
+                            for (unsigned int l = 0; l < resolvers.size(); ++l) {
+                                if (not p.possible(resolvers[l])) {
+                                    disallowedResolvers.push_back(resolvers[l]);
                                 }
+                            }
+                            if (disallowedResolvers.size() == resolvers.size()) {
+                                blacklisted = true;
+                                file << " <FONT COLOR=\"RED\">(uw)</FONT>";
+                                message("node %p is blacklisted: m%u cannot be safely resolved",
+                                        SK, static_cast<size_t>(SK->inner[j]));
+                                hiddenStates.insert(SK->inner[j]);
                             } else {
-                                file << " (t)";
+                                file << " <FONT COLOR=\"ORANGE\">(w)</FONT>";
                             }
+                        } else {
+                            file << " (t)";
                         }
                     }
-
-                    file << "<BR/>";
                 }
 
-                file << ">";
+                file << "<BR/>";
+            }
 
-                if (blacklisted) {
-                    file << " color=red";
-                }
-                file << "]\n";
+            file << ">";
 
-                if (not hiddenStates.empty()) {
-                    FOREACH(it1, hiddenStates) {
-                        FOREACH(it2, hiddenStates) {
-                            if (*it1 != *it2) {
-                                message("you need to fix m%u", lastCommonPredecessor(*it1, *it2));
-                            }
+            if (blacklisted) {
+                file << " color=red";
+            }
+            file << "]\n";
+
+            if (not hiddenStates.empty()) {
+                FOREACH(it1, hiddenStates) {
+                    FOREACH(it2, hiddenStates) {
+                        if (*it1 != *it2) {
+                            message("you need to fix m%u", lastCommonPredecessor(*it1, *it2));
                         }
                     }
                 }
+            }
 
-                // draw the edges
-                for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-                    if (it->second[i]->successors[l - 1] != NULL and
-                            (StoredKnowledge::seen.find(it->second[i]->successors[l - 1]) != StoredKnowledge::seen.end())) {
-                        file << "\"" << it->second[i] << "\" -> \""
-                             << it->second[i]->successors[l - 1]
-                             << "\" [label=\"" << PREFIX(l)
-                             << Label::id2name[l] << "\"]\n";
-                    }
+            // draw the edges
+            for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
+                if (SK->successor(l) != NULL and
+                        (StoredKnowledge::seen.find(SK->successor(l)) != StoredKnowledge::seen.end())) {
+                    file << "\"" << SK << "\" -> \""
+                         << SK->successor(l)
+                         << "\" [label=\"" << PREFIX(l)
+                         << Label::id2name[l] << "\"]\n";
                 }
             }
         }
@@ -378,9 +377,9 @@ InnerMarking_ID Diagnosis::lastCommonPredecessor(InnerMarking_ID m1, InnerMarkin
         // for each marking: add yourself and your direct successors
         for (InnerMarking_ID m = 0; m < InnerMarking::stats.markings; ++m) {
             reachable[m].insert(m);
-            InnerMarking* current = InnerMarking::inner_markings[m];
-            for (uint8_t succ = 0; succ < current->out_degree; ++succ) {
-                reachable[m].insert(current->successors[succ]);
+            const InnerMarking_ID* successors = InnerMarking::successorIds(m);
+            for (uint8_t succ = 0; succ < InnerMarking::outDegree(m); ++succ) {
+                reachable[m].insert(successors[succ]);
             }
         }
 
@@ -389,9 +388,9 @@ InnerMarking_ID Diagnosis::lastCommonPredecessor(InnerMarking_ID m1, InnerMarkin
         do {
             done = true;
             for (InnerMarking_ID m = 0; m < InnerMarking::stats.markings; ++m) {
-                InnerMarking* current = InnerMarking::inner_markings[m];
-                for (uint8_t succ = 0; succ < current->out_degree; ++succ) {
-                    FOREACH(it, reachable[current->successors[succ]]) {
+                const InnerMarking_ID* successors = InnerMarking::successorIds(m);
+                for (uint8_t succ = 0; succ < InnerMarking::outDegree(m); ++succ) {
+                    FOREACH(it, reachable[successors[succ]]) {
                         if (reachable[m].insert(*it).second) {
                             done = false;
                         }
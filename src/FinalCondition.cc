@@ -0,0 +1,244 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <cstring>
+#include "FinalCondition.h"
+#include "InnerMarking.h"
+#include "util.h"
+#include "verbose.h"
+
+using pnapi::formula::Formula;
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+std::vector<const pnapi::Place*> FinalCondition::places;
+std::vector<std::string> FinalCondition::names;
+std::vector<uint32_t> FinalCondition::table;
+std::vector<FinalCondition::Instruction> FinalCondition::program;
+int32_t FinalCondition::entry = 0;
+
+
+/// the target of an instruction if the final condition is satisfied
+#define ACCEPT -1
+
+/// the target of an instruction if the final condition is not satisfied
+#define REJECT -2
+
+
+/****************************
+ * STATIC MEMBER FUNCTIONS *
+ ****************************/
+
+void FinalCondition::initialize() {
+    places.clear();
+    names.clear();
+    program.clear();
+
+    FOREACH(p, InnerMarking::net->getPlaces()) {
+        places.push_back(*p);
+        names.push_back((*p)->getName());
+    }
+
+    // a hash table with a load factor of at most 1/2
+    size_t slots = 16;
+    while (slots < 2 * places.size()) {
+        slots *= 2;
+    }
+    table.assign(slots, 0);
+    for (size_t i = 0; i < places.size(); ++i) {
+        size_t slot = hash(names[i].c_str()) & (slots - 1);
+        while (table[slot] != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        table[slot] = i + 1;
+    }
+
+    entry = compile(InnerMarking::net->getFinalCondition().getFormula(), ACCEPT, REJECT);
+
+    status("compiled the final condition into %d comparisons", program.size());
+}
+
+
+/*!
+ Compiles the given formula such that evaluation continues with onTrue if
+ the formula holds and with onFalse otherwise. The children of an operator
+ are compiled from the last to the first, because each child continues with
+ its successor (or the given targets).
+
+ \return the first instruction of the formula; can be one of the given
+         targets if no comparison is needed (e.g., for true or false)
+*/
+int32_t FinalCondition::compile(const Formula& f, const int32_t& onTrue, const int32_t& onFalse) {
+    switch (f.getType()) {
+        case Formula::F_TRUE:
+            return onTrue;
+
+        case Formula::F_FALSE:
+            return onFalse;
+
+        case Formula::F_NEGATION: {
+            const pnapi::formula::Operator& o = static_cast<const pnapi::formula::Operator&>(f);
+            return compile(**o.getChildren().begin(), onFalse, onTrue);
+        }
+
+        case Formula::F_CONJUNCTION:
+        case Formula::F_DISJUNCTION: {
+            const pnapi::formula::Operator& o = static_cast<const pnapi::formula::Operator&>(f);
+            const bool conjunction = (f.getType() == Formula::F_CONJUNCTION);
+
+            // an empty conjunction holds and an empty disjunction fails
+            int32_t next = conjunction ? onTrue : onFalse;
+            std::vector<const Formula*> children(o.getChildren().begin(), o.getChildren().end());
+            for (size_t i = children.size(); i > 0; --i) {
+                next = conjunction ? compile(*children[i - 1], next, onFalse)
+                                   : compile(*children[i - 1], onTrue, next);
+            }
+            return next;
+        }
+
+        default: {
+            const pnapi::formula::Proposition& p = static_cast<const pnapi::formula::Proposition&>(f);
+            const size_t place = index(p.getPlace().getName().c_str());
+            assert(place < places.size());
+
+            Instruction instruction;
+            instruction.type = f.getType();
+            instruction.place = place;
+            instruction.tokens = p.getTokens();
+            instruction.onTrue = onTrue;
+            instruction.onFalse = onFalse;
+            program.push_back(instruction);
+            return program.size() - 1;
+        }
+    }
+}
+
+
+/*!
+ \param[in] tokens  the token count of each place (see index())
+
+ \return whether the marking satisfies the final condition
+*/
+bool FinalCondition::satisfied(const unsigned int* tokens) {
+    int32_t pc = entry;
+    while (pc >= 0) {
+        const Instruction& i = program[pc];
+        const unsigned int t = tokens[i.place];
+
+        bool result;
+        switch (i.type) {
+            case Formula::F_EQUAL:         result = (t == i.tokens); break;
+            case Formula::F_NOT_EQUAL:     result = (t != i.tokens); break;
+            case Formula::F_GREATER:       result = (t >  i.tokens); break;
+            case Formula::F_GREATER_EQUAL: result = (t >= i.tokens); break;
+            case Formula::F_LESS:          result = (t <  i.tokens); break;
+            default:                       result = (t <= i.tokens); break;
+        }
+
+        pc = result ? i.onTrue : i.onFalse;
+    }
+
+    return (pc == ACCEPT);
+}
+
+
+/*!
+ Checks whether the final condition is unsatisfiable for every marking that
+ has at least the given number of tokens on the given place. The program is
+ traversed without looking at other places, so both targets of their
+ comparisons are followed. The check is therefore conservative: it may fail
+ although no such marking is final, but never succeeds if one is final.
+
+ \param[in] place   the index of the place
+ \param[in] tokens  the least number of tokens on the place
+
+ \return whether the final condition cannot hold
+*/
+bool FinalCondition::excludes(const size_t& place, const unsigned int& tokens) {
+    std::vector<bool> visited(program.size(), false);
+    std::vector<int32_t> todo(1, entry);
+
+    while (not todo.empty()) {
+        const int32_t pc = todo.back();
+        todo.pop_back();
+
+        if (pc == ACCEPT) {
+            return false;
+        }
+        if (pc == REJECT or visited[pc]) {
+            continue;
+        }
+        visited[pc] = true;
+
+        const Instruction& i = program[pc];
+        if (i.place != place) {
+            todo.push_back(i.onTrue);
+            todo.push_back(i.onFalse);
+            continue;
+        }
+
+        // the outcome of the comparison for token counts from tokens upwards
+        bool canHold = true, canFail = true;
+        switch (i.type) {
+            case Formula::F_EQUAL:         canHold = (i.tokens >= tokens); break;
+            case Formula::F_NOT_EQUAL:     canFail = (i.tokens >= tokens); break;
+            case Formula::F_GREATER:       canFail = (i.tokens >= tokens); break;
+            case Formula::F_GREATER_EQUAL: canFail = (i.tokens > tokens); break;
+            case Formula::F_LESS:          canHold = (i.tokens > tokens); break;
+            default:                       canHold = (i.tokens >= tokens); break;
+        }
+
+        if (canHold) {
+            todo.push_back(i.onTrue);
+        }
+        if (canFail) {
+            todo.push_back(i.onFalse);
+        }
+    }
+
+    return true;
+}
+
+
+size_t FinalCondition::index(const char* name) {
+    const size_t mask = table.size() - 1;
+    size_t slot = hash(name) & mask;
+    while (table[slot] != 0) {
+        if (strcmp(names[table[slot] - 1].c_str(), name) == 0) {
+            return table[slot] - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return places.size();
+}
+
+
+/// FNV-1a hash of a place name
+hash_t FinalCondition::hash(const char* name) {
+    hash_t result = 14695981039346656037ULL;
+    for (; *name; ++name) {
+        result = (result ^ static_cast<uint8_t>(*name)) * 1099511628211ULL;
+    }
+    return result;
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <pnapi/pnapi.h>
+#include "types.h"
+
+
+/*!
+ \brief compiled final condition of the net
+
+ The final condition of the net is compiled once into a flat program over
+ dense place indices, so checking whether a marking is final needs neither
+ a PN API marking nor the virtual functions of the formula tree. Each
+ instruction compares the token count of a place with a constant and
+ continues with one of two instructions, depending on the result of the
+ comparison. Conjunctions, disjunctions, and negations only determine these
+ targets, so evaluation stops as soon as the result is known.
+
+ The places are numbered in the order of InnerMarking::net->getPlaces(), and
+ place names are mapped to these numbers with a hash table, so the parsers
+ of the reachability graph can collect the token counts of a marking in a
+ plain array.
+
+ \note This class is a static helper class from which no objects are built.
+*/
+class FinalCondition {
+    private: /* types */
+        /// an instruction of the compiled final condition
+        struct Instruction {
+            /// the comparison (a pnapi::formula::Formula::Type)
+            uint8_t type;
+
+            /// the index of the compared place
+            uint32_t place;
+
+            /// the number of tokens to compare with
+            unsigned int tokens;
+
+            /// the next instruction if the comparison holds
+            int32_t onTrue;
+
+            /// the next instruction if the comparison fails
+            int32_t onFalse;
+        };
+
+    public: /* static functions */
+        /// numbers the places and compiles the final condition
+        static void initialize();
+
+        /// the number of places
+        inline static size_t placeCount() {
+            return places.size();
+        }
+
+        /// the place with the given index
+        inline static const pnapi::Place* place(const size_t& i) {
+            return places[i];
+        }
+
+        /// returns the index of the place with the given name (or placeCount() if there is none)
+        static size_t index(const char*);
+
+        /// whether the given token counts (indexed by place) satisfy the final condition
+        static bool satisfied(const unsigned int*);
+
+        /// whether no marking with at least the given tokens on a place is final
+        static bool excludes(const size_t&, const unsigned int&);
+
+    private: /* static functions */
+        /// compiles a formula, given the instructions to continue with
+        static int32_t compile(const pnapi::formula::Formula&, const int32_t&, const int32_t&);
+
+        /// hashes a place name
+        static hash_t hash(const char*);
+
+    private: /* static attributes */
+        /// the places, ordered by their indices
+        static std::vector<const pnapi::Place*> places;
+
+        /// the names of the places, ordered by their indices
+        static std::vector<std::string> names;
+
+        /// hash table of place indices (indices + 1; 0 marks an empty slot)
+        static std::vector<uint32_t> table;
+
+        /// the compiled final condition
+        static std::vector<Instruction> program;
+
+        /// the first instruction of the program (or ACCEPT/REJECT)
+        static int32_t entry;
+};
@@ -20,10 +20,12 @@
 
 #include <config.h>
 #include <climits>
+#include <cstring>
 #include <algorithm>
 #include "InnerMarking.h"
 #include "Diagnosis.h"
 #include "Label.h"
+#include "StateSpaceCache.h"
 #include "cmdline.h"
 #include "verbose.h"
 #include "util.h"
@@ -40,45 +42,93 @@ std::map<InnerMarking_ID, InnerMarking*> InnerMarking::markingMap;
 std::map<InnerMarking_ID, bool> InnerMarking::finalMarkingReachableMap;
 pnapi::PetriNet* InnerMarking::net = new pnapi::PetriNet();
 bool InnerMarking::is_acyclic = true;
-InnerMarking** InnerMarking::inner_markings = NULL;
-std::map<Label_ID, std::set<InnerMarking_ID> > InnerMarking::receivers;
-std::map<Label_ID, std::set<InnerMarking_ID> > InnerMarking::synchs;
+bool InnerMarking::lazy = false;
+std::vector<InnerMarking*> InnerMarking::lazyMarkings;
 InnerMarking::_stats InnerMarking::stats;
+InnerMarking::_graph InnerMarking::graph = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0 };
 
 /******************
  * STATIC METHODS *
  ******************/
 
 /*!
- Copy the markings from the mapping markingMap to C-style arrays.
- Additionally, a mapping is filled to quickly determine whether a marking can
- become transient if a message with a given label was sent to the net.
-
- \todo replace the mapping receivers and synchs by a single two-dimensional
-       C-style array or do this check in the constructor
+ Copy the markings from the mapping markingMap to the compressed sparse row
+ layout and delete them. Additionally, a bit matrix is filled to quickly
+ determine whether a marking can become transient if a message with a given
+ label was sent to the net or by synchronization (see activatedBy()).
+
+ If the markings were read from a cache file, they are already stored in
+ the compressed sparse row layout. If they are expanded on the fly, there is
+ nothing to organize.
  */
 void InnerMarking::initialize() {
-    assert(stats.markings == markingMap.size());
-    inner_markings = new InnerMarking*[stats.markings];
+    if (lazy) {
+        return;
+    }
 
-    // copy data from STL mapping (used during parsing) to a C array
-    for (InnerMarking_ID i = 0; i < stats.markings; ++i) {
-        assert(markingMap[i]);
-
-        inner_markings[i] = markingMap[i];
-        inner_markings[i]->is_bad = (inner_markings[i]->is_bad or
-                                     (finalMarkingReachableMap.find(i) != finalMarkingReachableMap.end()
-                                      and finalMarkingReachableMap[i] == false
-                                      and not args_info.noDeadlockDetection_flag));
-
-        // register markings that may become activated by sending a message
-        // to them or by synchronization
-        for (uint8_t j = 0; j < inner_markings[i]->out_degree; ++j) {
-            if (SENDING(inner_markings[i]->labels[j])) {
-                receivers[inner_markings[i]->labels[j]].insert(i);
+    if (not StateSpaceCache::loaded()) {
+        assert(stats.markings == markingMap.size());
+
+        // count the edges to allocate the arrays at once
+        uint32_t edges = 0;
+        FOREACH(it, markingMap) {
+            edges += it->second->out_degree;
+        }
+
+        const size_t words = stats.markings / 64 + 1;
+        graph.offsets = new uint32_t[stats.markings + 1];
+        graph.successors = new InnerMarking_ID[edges];
+        graph.labels = new Label_ID[edges];
+        graph.is_final = new uint64_t[words]();
+        graph.is_waitstate = new uint64_t[words]();
+        graph.is_bad = new uint64_t[words]();
+        graph.sendEvents = new uint64_t[stats.markings * PossibleSendEvents::words]();
+
+        // copy data from STL mapping (used during parsing) to the arrays
+        edges = 0;
+        for (InnerMarking_ID i = 0; i < stats.markings; ++i) {
+            InnerMarking* m = markingMap[i];
+            assert(m);
+
+            graph.offsets[i] = edges;
+            std::copy(m->successors, m->successors + m->out_degree, graph.successors + edges);
+            std::copy(m->labels, m->labels + m->out_degree, graph.labels + edges);
+            edges += m->out_degree;
+
+            const uint64_t bit = static_cast<uint64_t>(1) << (i % 64);
+            if (m->is_final) {
+                graph.is_final[i / 64] |= bit;
+            }
+            if (m->is_waitstate) {
+                graph.is_waitstate[i / 64] |= bit;
+            }
+            if (m->is_bad or
+                    (finalMarkingReachableMap.find(i) != finalMarkingReachableMap.end()
+                     and finalMarkingReachableMap[i] == false
+                     and not args_info.noDeadlockDetection_flag)) {
+                graph.is_bad[i / 64] |= bit;
             }
-            if (SYNC(inner_markings[i]->labels[j])) {
-                synchs[inner_markings[i]->labels[j]].insert(i);
+            if (m->possibleSendEvents != NULL) {
+                memcpy(graph.sendEvents + i * PossibleSendEvents::words,
+                       m->possibleSendEvents->data(), PossibleSendEvents::words * sizeof(uint64_t));
+            }
+
+            delete m;
+        }
+        graph.offsets[stats.markings] = edges;
+    }
+
+    // register markings that may become activated by sending a message
+    // to them or by synchronization
+    graph.labelWords = (Label::send_events + Label::sync_events) / 64 + 1;
+    graph.activatedBy = new uint64_t[stats.markings * graph.labelWords]();
+    for (InnerMarking_ID i = 0; i < stats.markings; ++i) {
+        const Label_ID* labels = successorLabels(i);
+        uint64_t* bits = graph.activatedBy + i * graph.labelWords;
+        for (uint8_t j = 0; j < outDegree(i); ++j) {
+            if (SENDING(labels[j]) or SYNC(labels[j])) {
+                const Label_ID bit = labels[j] - Label::first_send;
+                bits[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
             }
         }
     }
@@ -104,10 +154,28 @@ void InnerMarking::initialize() {
 
 void InnerMarking::finalize() {
     delete net;
-    for (InnerMarking_ID i = 0; i < stats.markings; ++i) {
-        delete inner_markings[i];
+    delete[] graph.activatedBy;
+
+    if (lazy) {
+        FOREACH(m, lazyMarkings) {
+            delete *m;
+        }
+        std::vector<InnerMarking*>().swap(lazyMarkings);
+        StateSpace::finalize();
+    }
+
+    // the arrays of cached markings belong to the cache file
+    if (StateSpaceCache::loaded()) {
+        StateSpaceCache::finalize();
+    } else {
+        delete[] graph.offsets;
+        delete[] graph.successors;
+        delete[] graph.labels;
+        delete[] graph.is_final;
+        delete[] graph.is_waitstate;
+        delete[] graph.is_bad;
+        delete[] graph.sendEvents;
     }
-    delete[] inner_markings;
 
     status("InnerMarking: deleted %d objects", stats.markings);
 }
@@ -190,28 +258,32 @@ void InnerMarking::determineType(const InnerMarking_ID& myId) {
     }
 
     // when only deadlocks are considered, we don't care about final markings
-    finalMarkingReachableMap[myId] = (args_info.correctness_arg == correctness_arg_livelock and
-                                      not args_info.noDeadlockDetection_flag) ? is_final : true;
+    // (markings expanded on the fly are only checked for deadlocks)
+    if (not lazy) {
+        finalMarkingReachableMap[myId] = (args_info.correctness_arg == correctness_arg_livelock and
+                                          not args_info.noDeadlockDetection_flag) ? is_final : true;
+    }
 
     // variable to detect whether this marking has only deadlocking successors
     // standard: "true", otherwise evaluate noDeadlockDetection flag
     bool deadlock_inevitable = not args_info.noDeadlockDetection_flag;
     for (uint8_t i = 0; i < out_degree; ++i) {
         // if a single successor is not a deadlock, everything is OK
-        if (markingMap[successors[i]] != NULL and
+        const InnerMarking* successor = known(successors[i]);
+        if (successor != NULL and
                 deadlock_inevitable and
-                not markingMap[successors[i]]->is_bad) {
+                not successor->is_bad) {
             deadlock_inevitable = false;
         }
 
         // if we have not seen a successor yet, we can't be a deadlock
-        if (markingMap[successors[i]] == NULL) {
+        if (successor == NULL) {
             deadlock_inevitable = false;
         }
 
         if (args_info.correctness_arg == correctness_arg_livelock and
                 not args_info.noDeadlockDetection_flag) {
-            if (markingMap[successors[i]] != NULL and
+            if (successor != NULL and
                     (finalMarkingReachableMap.find(successors[i]) != finalMarkingReachableMap.end() and
                      finalMarkingReachableMap[successors[i]] == true)) {
 
@@ -240,14 +312,15 @@ void InnerMarking::determineType(const InnerMarking_ID& myId) {
 }
 
 
-bool InnerMarking::waitstate(const Label_ID& l) const {
+bool InnerMarking::waitstate(const InnerMarking_ID& m, const Label_ID& l) {
     assert(not RECEIVING(l));
 
-    if (not is_waitstate) {
+    if (not isWaitstate(m)) {
         return false;
     }
 
-    for (uint8_t i = 0; i < out_degree; ++i) {
+    const Label_ID* labels = successorLabels(m);
+    for (uint8_t i = 0; i < outDegree(m); ++i) {
         if (labels[i] == l) {
             return true;
         }
@@ -257,26 +330,25 @@ bool InnerMarking::waitstate(const Label_ID& l) const {
 }
 
 /*!
-  checks if each (input) message lying on the interface of the current
-  marking will be ever be consumed, that is if from the current inner marking
+  checks if each (input) message lying on the interface of the given
+  marking will be ever be consumed, that is if from the given inner marking
   a receiving transition is reachable that will consume this message
 
-  \param[in] interface the interface that corresponds to the current inner
+  \param[in] m the inner marking
+  \param[in] interface the interface that corresponds to the given inner
              marking being part of a certain knowledge
   \return true if all (input) messages of the interface will be consumed
           later on; false, otherwise
 */
-bool InnerMarking::sentMessagesConsumed(const InterfaceMarking& interface) const {
-    assert(possibleSendEvents);
-    char* possibleSendEventsDecoded = possibleSendEvents->decode();
-    assert(possibleSendEventsDecoded);
+bool InnerMarking::sentMessagesConsumed(const InnerMarking_ID& m, const InterfaceMarking& interface) {
+    const uint64_t* events = sendEvents(m);
 
     // iterate over all possible input messages
     for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
         // if input message is on the interface, but message can not be
-        // consumed by any marking being reached from the current one,
+        // consumed by any marking being reached from the given one,
         // return with false
-        if (interface.marked(l) and not possibleSendEventsDecoded[l - Label::first_send]) {
+        if (interface.marked(l) and not PossibleSendEvents::possible(events, l)) {
             return false;
         }
     }
@@ -285,6 +357,102 @@ bool InnerMarking::sentMessagesConsumed(const InterfaceMarking& interface) const
 }
 
 
+/*!
+  reduction rule: smart sending event (markings expanded on the fly)
+
+  Collects the sending events reachable from the given marking the first
+  time they are needed. The markings reachable from it are searched depth
+  first, expanding them if necessary, and Tarjan's algorithm assigns the
+  same events to all members of an SCC. Markings whose events are already
+  known are not searched again.
+
+  \param[in] m  the marking
+  \return the sending events reachable from m
+*/
+const uint64_t* InnerMarking::lazySendEvents(const InnerMarking_ID& m) {
+    if (lazyMarking(m).possibleSendEvents != NULL) {
+        return lazyMarkings[m]->possibleSendEvents->data();
+    }
+
+    // the search stack (marking and next successor) and Tarjan's stack
+    std::vector<std::pair<InnerMarking_ID, uint8_t> > search;
+    std::vector<InnerMarking_ID> stack;
+    std::map<InnerMarking_ID, size_t> number;
+    std::vector<size_t> lowlink;
+
+    number[m] = 0;
+    lowlink.push_back(0);
+    stack.push_back(m);
+    search.push_back(std::make_pair(m, 0));
+
+    while (not search.empty()) {
+        const InnerMarking_ID current = search.back().first;
+        const InnerMarking& marking = lazyMarking(current);
+        const size_t n = number[current];
+
+        if (search.back().second < marking.out_degree) {
+            const InnerMarking_ID successor = marking.successors[search.back().second++];
+
+            // the events of finished markings are known
+            if (lazyMarking(successor).possibleSendEvents != NULL) {
+                continue;
+            }
+
+            std::map<InnerMarking_ID, size_t>::const_iterator s = number.find(successor);
+            if (s == number.end()) {
+                number[successor] = lowlink.size();
+                lowlink.push_back(lowlink.size());
+                stack.push_back(successor);
+                search.push_back(std::make_pair(successor, 0));
+            } else {
+                // the successor is unfinished and hence on Tarjan's stack
+                lowlink[n] = std::min(lowlink[n], s->second);
+            }
+            continue;
+        }
+
+        search.pop_back();
+        if (not search.empty()) {
+            const size_t parent = number[search.back().first];
+            lowlink[parent] = std::min(lowlink[parent], lowlink[n]);
+        }
+        if (lowlink[n] != n) {
+            continue;
+        }
+
+        // the marking is the representative of an SCC: collect its members
+        std::vector<InnerMarking*> scc;
+        InnerMarking_ID top;
+        do {
+            top = stack.back();
+            stack.pop_back();
+            scc.push_back(lazyMarkings[top]);
+        } while (top != current);
+
+        // the members of the SCC are the only reachable markings without events
+        PossibleSendEvents* events = new PossibleSendEvents();
+        FOREACH(member, scc) {
+            for (uint8_t i = 0; i < (*member)->out_degree; ++i) {
+                if (SENDING((*member)->labels[i])) {
+                    events->labelPossible((*member)->labels[i]);
+                }
+                const InnerMarking* successor = lazyMarkings[(*member)->successors[i]];
+                if (successor->possibleSendEvents != NULL) {
+                    *events |= *successor->possibleSendEvents;
+                }
+            }
+        }
+
+        for (size_t i = 1; i < scc.size(); ++i) {
+            scc[i]->possibleSendEvents = new PossibleSendEvents(*events);
+        }
+        scc[0]->possibleSendEvents = events;
+    }
+
+    return lazyMarkings[m]->possibleSendEvents->data();
+}
+
+
 /*!
   reduction rule: smart sending event
 
@@ -312,7 +480,7 @@ void InnerMarking::calcReachableSendingEvents() {
                 if (SENDING(labels[i]) and(consideredLabels.find(labels[i]) == consideredLabels.end())) {
 
                     // add current sending event
-                    *possibleSendEvents |= PossibleSendEvents(false, labels[i]);
+                    possibleSendEvents->labelPossible(labels[i]);
 
                     consideredLabels[labels[i]] = true;
                 }
@@ -461,6 +629,55 @@ void InnerMarking::finalMarkingReachableSCC(std::set<InnerMarking_ID>& markingSe
 }
 
 
+/*!
+ Calculates strongly connected components and does some evaluation on their
+ members. This function is called for each marking right after it has been
+ created. As the markings are created in the order in which the depth-first
+ search finishes them, all members of an SCC are known when its
+ representative is created.
+
+ \param[in] id       the identifier of the marking that has just been created
+ \param[in] lowlink  the Tarjan lowlink value of that marking
+ \param[in] scc      the other members of the SCC if the marking is the
+                     representative of an SCC; empty otherwise
+
+ \post scc is empty
+*/
+void InnerMarking::evaluateSCC(const InnerMarking_ID& id, const InnerMarking_ID& lowlink,
+                               std::set<InnerMarking_ID>& scc) {
+    // current marking is representative of an SCC and either reduction by
+    // smart sending events or correctness criteria livelock freedom is turned on
+    if ((lowlink == id and not args_info.ignoreUnreceivedMessages_flag)
+            or args_info.correctness_arg == correctness_arg_livelock) {
+
+        // insert representative into current SCC of inner markings
+        scc.insert(id);
+
+        // we have found a non-trivial SCC within the inner markings, so the reachability graph
+        // contains a cycle
+        if (scc.size() > 1) {
+            is_acyclic = false;
+        }
+
+        // reduction by smart sending events is turned on
+        if (not args_info.ignoreUnreceivedMessages_flag) {
+            if (scc.size() == 1) {
+                // it is a trivial SCC: analyze only representative with respect to possible sending events
+                markingMap[id]->calcReachableSendingEvents();
+            } else {
+                // analyze all members of current SCC with respect to possible sending events and final markings reachable
+                analyzeSCCOfInnerMarkings(scc);
+            }
+        } else if (args_info.ignoreUnreceivedMessages_flag and args_info.correctness_arg == correctness_arg_livelock) {
+            // no smart sending event reduction but livelock freedom is turned on
+            finalMarkingReachableSCC(scc);
+        }
+    }
+
+    scc.clear();
+}
+
+
 void InnerMarking::output_results(Results& r) {
     r.add("statistics.inner_markings", InnerMarking::stats.markings);
     r.add("statistics.inner_markings_final", InnerMarking::stats.final_markings);
@@ -25,7 +25,9 @@
 #include <set>
 #include "PossibleSendEvents.h"
 #include "InterfaceMarking.h"
+#include "Label.h"
 #include "Results.h"
+#include "StateSpace.h"
 
 
 /*!
@@ -37,14 +39,30 @@
  identifiers of the successors and one consisting of the interface labels of
  the respective transitions.
 
- The reachability graph of the inner of the net is created by LoLA and then
- parsed. The parser creates objects of this class and stores pointers to them
- in the mapping markingMap together with an identifier (the depth-first
- search number given by LoLA). After all markings are parsed, the function
- initialize() is called to copy the markingMap into a C-style array.
+ The reachability graph of the inner of the net is either calculated by the
+ class StateSpace or created by LoLA and then parsed. Both create objects of
+ this class and store pointers to them in the mapping markingMap together
+ with an identifier (the depth-first search number). After all markings are
+ created, the function initialize() copies them into a compressed sparse row
+ layout (see struct _graph) and deletes the objects. From then on, markings
+ are only accessed by their identifiers using the static functions of this
+ class.
+
+ Alternatively, the arrays of the compressed sparse row layout are read from
+ a cache file (see class StateSpaceCache). Then they point into that file.
+
+ With option --onTheFly, the reachability graph is not calculated in
+ advance. Instead, the static functions ask class StateSpace to expand a
+ marking the first time they are called for it, and the created objects are
+ kept in lazyMarkings. The inevitable deadlocks are then only detected from
+ the successors known at that time, and the sending events reachable from a
+ marking are collected when they are first needed (see lazySendEvents()).
 */
 class InnerMarking {
         friend class Diagnosis;
+        friend class StateSpace;
+        friend class StateSpaceCache;
+        friend class StructuralReduction;
 
     public: /* static functions */
         /// copy markings from temporary storage to array
@@ -53,6 +71,84 @@ class InnerMarking {
         /// destroy all objects of this class
         static void finalize();
 
+        /// whether the given marking is final
+        inline static bool isFinal(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).is_final;
+            }
+            return (graph.is_final[m / 64] >> (m % 64)) & 1;
+        }
+
+        /// whether the given marking needs an external event to proceed
+        inline static bool isWaitstate(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).is_waitstate;
+            }
+            return (graph.is_waitstate[m / 64] >> (m % 64)) & 1;
+        }
+
+        /// whether the given marking is an internal deadlock or livelock
+        inline static bool isBad(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).is_bad;
+            }
+            return (graph.is_bad[m / 64] >> (m % 64)) & 1;
+        }
+
+        /// the number of successor markings of the given marking
+        inline static uint8_t outDegree(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).out_degree;
+            }
+            return graph.offsets[m + 1] - graph.offsets[m];
+        }
+
+        /// the successor marking ids of the given marking
+        inline static const InnerMarking_ID* successorIds(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).successors;
+            }
+            return graph.successors + graph.offsets[m];
+        }
+
+        /// the successor label ids of the given marking
+        inline static const Label_ID* successorLabels(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazyMarking(m).labels;
+            }
+            return graph.labels + graph.offsets[m];
+        }
+
+        /// the sending events that are potentially reachable from the given marking
+        inline static const uint64_t* sendEvents(const InnerMarking_ID& m) {
+            if (lazy) {
+                return lazySendEvents(m);
+            }
+            return graph.sendEvents + m * PossibleSendEvents::words;
+        }
+
+        /// whether a transition with the given sending or synchronous label leaves the given marking
+        inline static bool activatedBy(const InnerMarking_ID& m, const Label_ID& l) {
+            assert(SENDING(l) or SYNC(l));
+            if (lazy) {
+                const InnerMarking& marking = lazyMarking(m);
+                for (uint8_t i = 0; i < marking.out_degree; ++i) {
+                    if (marking.labels[i] == l) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            const Label_ID bit = l - Label::first_send;
+            return (graph.activatedBy[m * graph.labelWords + bit / 64] >> (bit % 64)) & 1;
+        }
+
+        /// whether the given marking is a waitstate resolvable by the given label
+        static bool waitstate(const InnerMarking_ID&, const Label_ID&);
+
+        /// checks if all input messages will be consumed later on
+        static bool sentMessagesConsumed(const InnerMarking_ID&, const InterfaceMarking&);
+
         /// print results
         static void output_results(Results&);
 
@@ -63,6 +159,29 @@ class InnerMarking {
         /// analyze non-trivial SCC of inner markings with respect to reachable final inner markings (in case of livelock freedom only)
         static void finalMarkingReachableSCC(std::set<InnerMarking_ID>& markingSet);
 
+        /// evaluate the SCC of a marking once all its members are known
+        static void evaluateSCC(const InnerMarking_ID&, const InnerMarking_ID&, std::set<InnerMarking_ID>&);
+
+    private: /* static functions */
+        /// the object of the given marking, which is expanded if necessary (see lazy)
+        inline static const InnerMarking& lazyMarking(const InnerMarking_ID& m) {
+            if (m >= lazyMarkings.size() or lazyMarkings[m] == NULL) {
+                StateSpace::expand(m);
+            }
+            return *lazyMarkings[m];
+        }
+
+        /// the sending events reachable from the given marking (see lazy)
+        static const uint64_t* lazySendEvents(const InnerMarking_ID&);
+
+        /// the object of the given marking if it is already created
+        inline static const InnerMarking* known(const InnerMarking_ID& m) {
+            if (lazy) {
+                return (m < lazyMarkings.size()) ? lazyMarkings[m] : NULL;
+            }
+            return markingMap[m];
+        }
+
     public: /* static attributes */
         /// a temporary storage used during parsing of the reachability graph
         static std::map<InnerMarking_ID, InnerMarking*> markingMap;
@@ -70,22 +189,20 @@ class InnerMarking {
         /// a temporary storage used to detect internal livelocks
         static std::map<InnerMarking_ID, bool> finalMarkingReachableMap;
 
-        /// an array of the inner markings
-        static InnerMarking** inner_markings;
-
-        /// a mapping from labels to inner markings that might receive this message
-        static std::map<Label_ID, std::set<InnerMarking_ID> > receivers;
-
-        /// a mapping from labels to inner markings that can synchronize with this label
-        static std::map<Label_ID, std::set<InnerMarking_ID> > synchs;
-
         /// the open net that created these inner markings
         static pnapi::PetriNet* net;
 
         /// remember if the reachability graph of the inner is acyclic
         static bool is_acyclic;
 
+        /// whether the markings are expanded on the fly (option --onTheFly)
+        static bool lazy;
+
     private: /* static attributes */
+        /// the markings expanded on the fly, indexed by their identifiers
+        /// (NULL for markings that are stored but not expanded yet)
+        static std::vector<InnerMarking*> lazyMarkings;
+
         /// struct combining the statistics on the class InnerMarking
         static struct _stats {
             /// the number of total markings
@@ -101,6 +218,41 @@ class InnerMarking {
             unsigned int final_markings;
         } stats;
 
+        /// the inner markings in compressed sparse row layout
+        static struct _graph {
+            /// the position of the first successor of each marking in the
+            /// arrays successors and labels (with an additional entry for
+            /// the end of the last marking's successors)
+            uint32_t* offsets;
+
+            /// the successor marking ids of all markings
+            InnerMarking_ID* successors;
+
+            /// the successor label ids of all markings
+            Label_ID* labels;
+
+            /// bitset of the final markings
+            uint64_t* is_final;
+
+            /// bitset of the waitstates
+            uint64_t* is_waitstate;
+
+            /// bitset of the internal deadlocks and livelocks
+            uint64_t* is_bad;
+
+            /// the possible sending events of all markings
+            /// (PossibleSendEvents::words per marking)
+            uint64_t* sendEvents;
+
+            /// the sending and synchronous labels of the transitions leaving
+            /// each marking (labelWords bitset words per marking, starting
+            /// with label Label::first_send)
+            uint64_t* activatedBy;
+
+            /// the number of words of each bitset in activatedBy
+            size_t labelWords;
+        } graph;
+
     public: /* member functions */
         /// constructor
         InnerMarking(const InnerMarking_ID&, const std::vector<Label_ID>&,
@@ -109,12 +261,6 @@ class InnerMarking {
         /// destructor
         ~InnerMarking();
 
-        /// whether this marking is a waitstate resolvable by the given label
-        bool waitstate(const Label_ID&) const;
-
-        /// checks if all input messages will be consumed later on
-        bool sentMessagesConsumed(const InterfaceMarking&) const;
-
         /// determines which receiving transitions are potentially reachable from this marking
         void calcReachableSendingEvents();
 
@@ -21,9 +21,11 @@
 #include <config.h>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include "cmdline.h"
 #include "InterfaceMarking.h"
 #include "Label.h"
+#include "Statistics.h"
 #include "verbose.h"
 
 // a fix for systems which do not know log2()
@@ -43,6 +45,9 @@ uint8_t InterfaceMarking::interface_length = 0;
 uint8_t InterfaceMarking::message_bound_bits = 0;
 uint8_t InterfaceMarking::bytes = 0;
 uint8_t InterfaceMarking::markings_per_byte = 0;
+uint8_t InterfaceMarking::words = 0;
+bool InterfaceMarking::inline_storage = true;
+std::vector<InterfaceMarking::Field> InterfaceMarking::fields;
 
 
 /******************
@@ -66,8 +71,22 @@ void InterfaceMarking::initialize() {
     bytes = static_cast<uint8_t>(
                 ceil(static_cast<double>(interface_length) / static_cast<double>(markings_per_byte)));
 
+    // pad the bytes to whole words
+    words = (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    inline_storage = (words <= INLINE_WORDS);
+
+    // precalculate the position of each label (label 0 is not used)
+    fields.resize(interface_length + 1);
+    for (Label_ID l = 1; l <= interface_length; ++l) {
+        const unsigned int bit = ((l - 1) / markings_per_byte) * 8 + ((l - 1) % markings_per_byte) * message_bound_bits;
+        fields[l].word = bit / 64;
+        fields[l].offset = bit % 64;
+        fields[l].mask = ((1ULL << message_bound_bits) - 1) << fields[l].offset;
+    }
+
     status("message bound set to %d (%d bytes/interface marking, %d bits/event)",
            message_bound, bytes, message_bound_bits);
+    status("interface markings use %d words (%s)", words, inline_storage ? "inline" : "allocated");
 
     if (uint8_t wastedBytes = bytes - static_cast<uint8_t>(ceil(static_cast<double>(message_bound_bits * interface_length) / 8.0))) {
         message("%s: a better alignment could save %d bytes/interface marking", _cimportant_("note"), wastedBytes);
@@ -75,39 +94,13 @@ void InterfaceMarking::initialize() {
 }
 
 
-void InterfaceMarking::sort(std::vector<InterfaceMarking*> &v) {
-    if (v.size() <= 1) {
-        return;
-    }
-
-    std::vector<InterfaceMarking*> smaller;
-    std::vector<InterfaceMarking*> bigger;
-    InterfaceMarking& pivot = *v[0];
-
-    for (size_t i = 1; i < v.size(); ++i) {
-        if (*v[i] < pivot) {
-            smaller.push_back(v[i]);
-        } else {
-            bigger.push_back(v[i]);
-        }
-    }
-
-    sort(smaller);
-    sort(bigger);
-    v.clear();
-
-    v.insert(v.begin(), smaller.begin(), smaller.end());
-    v.push_back(&pivot);
-    v.insert(v.end(), bigger.begin(), bigger.end());
-}
-
-
-
 /***************
  * CONSTRUCTOR *
  ***************/
 
 InterfaceMarking::InterfaceMarking() : storage(NULL) {
+    Statistics::created(Statistics::INTERFACE_MARKING);
+
     // if no (asynchronous) events are present, we are done here
     if (interface_length == 0) {
         return;
@@ -118,12 +111,16 @@ InterfaceMarking::InterfaceMarking() : storage(NULL) {
     assert(bytes);
     assert(markings_per_byte);
 
-    // reserve memory and initialize to 0
-    storage = new uint8_t[bytes];
-    memset(storage, 0, bytes);
+    // reserve memory (unless the words are stored inline) and initialize to 0
+    if (not inline_storage) {
+        storage = new uint64_t[words];
+    }
+    clear();
 }
 
 InterfaceMarking::InterfaceMarking(const InterfaceMarking& other) : storage(NULL) {
+    Statistics::created(Statistics::INTERFACE_MARKING);
+
     // if no (asynchronous) events are present, we are done here
     if (interface_length == 0) {
         return;
@@ -134,11 +131,34 @@ InterfaceMarking::InterfaceMarking(const InterfaceMarking& other) : storage(NULL
     assert(bytes);
     assert(markings_per_byte);
 
-    // reserve memory and copy values
-    storage = new uint8_t[bytes];
+    // reserve memory (unless the words are stored inline) and copy values
+    if (not inline_storage) {
+        storage = new uint64_t[words];
+    }
+    copy(other);
+}
 
-    for (size_t i = 0; i < bytes; ++i) {
-        storage[i] = other.storage[i];
+
+/*!
+  This constructor does not allocate memory: the word array is provided by the
+  caller who also has to release it. Such markings are stored in the arena of
+  a knowledge (see class Knowledge) and are never destructed.
+
+  \param[in] memory  a word array of sufficient size; it is not used if the
+                     words are stored inline
+  \param[in] other   the interface marking to copy from; if NULL, the marking
+                     is empty
+*/
+InterfaceMarking::InterfaceMarking(uint64_t* memory, const InterfaceMarking* other) {
+    Statistics::created(Statistics::INTERFACE_MARKING);
+
+    if (not inline_storage) {
+        storage = memory;
+    }
+    if (other) {
+        copy(*other);
+    } else {
+        clear();
     }
 }
 
@@ -166,9 +186,8 @@ InterfaceMarking::InterfaceMarking(const InterfaceMarking& other) : storage(NULL
  */
 InterfaceMarking::InterfaceMarking(const InterfaceMarking& other,
                                    const Label_ID& label,
-                                   const bool& increase, bool& success) :
-    // reserve memory
-    storage(new uint8_t[bytes]) {
+                                   const bool& increase, bool& success) {
+    Statistics::created(Statistics::INTERFACE_MARKING);
 
     // initialize() must be called before first object is created
     assert(interface_length);
@@ -177,10 +196,11 @@ InterfaceMarking::InterfaceMarking(const InterfaceMarking& other,
     assert(markings_per_byte);
     assert(success);
 
-    // copy values
-    for (size_t i = 0; i < bytes; ++i) {
-        storage[i] = other.storage[i];
+    // reserve memory (unless the words are stored inline) and copy values
+    if (not inline_storage) {
+        storage = new uint64_t[words];
     }
+    copy(other);
 
     success = increase ? inc(label) : dec(label);
 }
@@ -191,7 +211,7 @@ InterfaceMarking::InterfaceMarking(const InterfaceMarking& other,
  **************/
 
 InterfaceMarking::~InterfaceMarking() {
-    if (interface_length > 0) {
+    if (interface_length > 0 and not inline_storage) {
         delete[] storage;
     }
 }
@@ -201,31 +221,33 @@ InterfaceMarking::~InterfaceMarking() {
  * OPERATORS *
  *************/
 
+/*!
+ \note The markings are compared lexicographically word by word. As the
+       padding bits are always 0, this is a strict weak ordering.
+*/
 bool InterfaceMarking::operator< (const InterfaceMarking& other) const {
-    for (size_t i = 0; i < bytes; ++i) {
-        if (storage[i] < other.storage[i]) {
-            return true;
+    const uint64_t* a = data();
+    const uint64_t* b = other.data();
+    for (size_t i = 0; i < words; ++i) {
+        if (a[i] != b[i]) {
+            return (a[i] < b[i]);
         }
     }
     return false;
 }
 
 bool InterfaceMarking::operator!= (const InterfaceMarking& other) const {
-    for (size_t i = 0; i < bytes; ++i) {
-        if (storage[i] != other.storage[i]) {
-            return true;
-        }
-    }
-    return false;
+    return not operator==(other);
 }
 
 bool InterfaceMarking::operator== (const InterfaceMarking& other) const {
-    for (size_t i = 0; i < bytes; ++i) {
-        if (storage[i] != other.storage[i]) {
-            return false;
-        }
+    const uint64_t* a = data();
+    const uint64_t* b = other.data();
+    uint64_t difference = 0;
+    for (size_t i = 0; i < words; ++i) {
+        difference |= (a[i] ^ b[i]);
     }
-    return true;
+    return (difference == 0);
 }
 
 std::ostream& operator<< (std::ostream& o, const InterfaceMarking& m) {
@@ -257,23 +279,43 @@ bool InterfaceMarking::isEqual(const uint8_t& value, const Label_ID& label) cons
 	return value == get(label);
 }
 
+/*!
+ \note Only the values are exchanged; each marking keeps its word array. Hence,
+       markings whose word array is owned by someone else stay where they are.
+*/
+void InterfaceMarking::swap(InterfaceMarking& other) {
+    uint64_t* a = data();
+    uint64_t* b = other.data();
+    for (size_t i = 0; i < words; ++i) {
+        const uint64_t temp = a[i];
+        a[i] = b[i];
+        b[i] = temp;
+    }
+}
+
 uint8_t InterfaceMarking::get(const Label_ID& label) const {
     assert(label > 0);
     assert(label <= interface_length);
 
-    // the byte in which this interface is stored
-    const unsigned int byte = (label - 1) / markings_per_byte;
-    // the offset inside the byte, i.e. the starting position
-    const uint8_t offset = ((label - 1) % markings_per_byte) * message_bound_bits;
+    const Field& field = fields[label];
 
-    // first, create (2**message_bound_bits)-1, then shift it to the needed position
-    const uint8_t mask = ((1 << message_bound_bits) - 1) << offset;
+    // get the result by masking the respective word and shift it back
+    return (data()[field.word] & field.mask) >> field.offset;
+}
 
-    // get the result by masking the respective byte
-    const uint8_t result = storage[byte] & mask;
+void InterfaceMarking::clear() {
+    uint64_t* a = data();
+    for (size_t i = 0; i < words; ++i) {
+        a[i] = 0;
+    }
+}
 
-    // shift back the result
-    return (result >> offset);
+void InterfaceMarking::copy(const InterfaceMarking& other) {
+    uint64_t* a = data();
+    const uint64_t* b = other.data();
+    for (size_t i = 0; i < words; ++i) {
+        a[i] = b[i];
+    }
 }
 
 /*!
@@ -283,30 +325,18 @@ bool InterfaceMarking::inc(const Label_ID& label) {
     assert(label > 0);
     assert(label <= interface_length);
 
-    // the byte in which this interface is stored
-    const unsigned int byte = (label - 1) / markings_per_byte;
-    // the offset inside the byte, i.e. the starting position
-    const uint8_t offset = ((label - 1) % markings_per_byte) * message_bound_bits;
+    const Field& field = fields[label];
+    uint64_t& word = data()[field.word];
 
-    // create a mask to select the bits we want to modify:
-    // (2**message_bound_bits)-1, then shift it to the needed position
-    const uint8_t mask = ((1 << message_bound_bits) - 1) << offset;
+    // use the mask to get the current value from the word
+    const uint64_t value = (word & field.mask) >> field.offset;
 
     // before increment, the value for this label should be smaller than the message bound
-    const bool OK = ((unsigned)((storage[byte] & mask) >> offset) < message_bound);
+    const bool OK = (value < message_bound);
 
-    // use the mask to get the current value from the byte,
-    // then shift and increment the value
-    const uint8_t update = ((storage[byte] & mask) >> offset) + 1;
-
-    // shift back and mask the value to store
-    const uint8_t result = ((update << offset) & mask);
-
-    // remove values of this label
-    const uint8_t crop = (storage[byte] & ~mask);
-
-    // combine incremented value and the stored byte
-    storage[byte] = (crop | result);
+    // remove the value of this label and combine the stored word with the
+    // updated value (shifted back and masked)
+    word = (word & ~field.mask) | (((value + 1) << field.offset) & field.mask);
 
     // return previously checked status
     return OK;
@@ -319,30 +349,18 @@ bool InterfaceMarking::dec(const Label_ID& label) {
     assert(label > 0);
     assert(label <= interface_length);
 
-    // the byte in which this interface is stored
-    const unsigned int byte = (label - 1) / markings_per_byte;
-    // the offset inside the byte, i.e. the starting position
-    const uint8_t offset = ((label - 1) % markings_per_byte) * message_bound_bits;
+    const Field& field = fields[label];
+    uint64_t& word = data()[field.word];
 
-    // create a mask to select the bits we want to modify:
-    // (2**message_bound_bits)-1, then shift it to the needed position
-    const uint8_t mask = ((1 << message_bound_bits) - 1) << offset;
+    // use the mask to get the current value from the word
+    const uint64_t value = (word & field.mask) >> field.offset;
 
     // before decrement, the value for this label should be positive
-    const bool OK = (((storage[byte] & mask) >> offset) > 0);
-
-    // use the mask to get the current value from the byte,
-    // then shift and decrement the value
-    const uint8_t update = ((storage[byte] & mask) >> offset) - 1;
+    const bool OK = (value > 0);
 
-    // shift back and mask the value to store
-    const uint8_t result = ((update << offset) & mask);
-
-    // remove values of this label
-    const uint8_t crop = (storage[byte] & ~mask);
-
-    // combine incremented value and the stored byte
-    storage[byte] = (crop | result);
+    // remove the value of this label and combine the stored word with the
+    // updated value (shifted back and masked)
+    word = (word & ~field.mask) | (((value - 1) << field.offset) & field.mask);
 
     // return previously checked status
     return OK;
@@ -352,12 +370,12 @@ bool InterfaceMarking::dec(const Label_ID& label) {
  \return whether the whole interface is unmarked
  */
 bool InterfaceMarking::unmarked() const {
-    for (size_t i = 0; i < bytes; ++i) {
-        if (storage[i] != 0) {
-            return false;
-        }
+    const uint64_t* a = data();
+    uint64_t marked = 0;
+    for (size_t i = 0; i < words; ++i) {
+        marked |= a[i];
     }
-    return true;
+    return (marked == 0);
 }
 
 /// returns whether the interface is unmarked for all receive labels
@@ -379,19 +397,10 @@ bool InterfaceMarking::marked(const Label_ID& label) const {
     assert(label > 0);
     assert(label <= interface_length);
 
-    // the byte in which this interface is stored
-    const unsigned int byte = (label - 1) / markings_per_byte;
-    // the offset inside the byte, i.e. the starting position
-    const uint8_t offset = ((label - 1) % markings_per_byte) * message_bound_bits;
-
-    // first, create (2**message_bound_bits)-1, then shift it to the needed position
-    const uint8_t mask = ((1 << message_bound_bits) - 1) << offset;
-
-    // get the result by masking the respective byte
-    const uint8_t result = storage[byte] & mask;
+    const Field& field = fields[label];
 
-    // shift back the result
-    return ((result >> offset) > 0);
+    // masking the respective word suffices
+    return (data()[field.word] & field.mask) != 0;
 }
 
 
@@ -413,10 +422,24 @@ bool InterfaceMarking::pendingOutput() const {
     return false;
 }
 
+/*!
+ \note The hash value is calculated word-wise: each word is combined by a
+       multiplication with the golden ratio, and the result is mixed with
+       the finalizer of MurmurHash3, so all bits of the marking influence
+       the lower bits used to address hash tables.
+ */
 hash_t InterfaceMarking::hash() const {
+    const uint64_t* a = data();
     hash_t result = 0;
-    for (unsigned int i = 0; i < bytes; ++i) {
-        result += (storage[i] << (7 * i));
+    for (size_t i = 0; i < words; ++i) {
+        result = (result ^ a[i]) * 0x9e3779b97f4a7c15ULL;
+        result ^= (result >> 32);
     }
+
+    result ^= (result >> 33);
+    result *= 0xff51afd7ed558ccdULL;
+    result ^= (result >> 33);
+    result *= 0xc4ceb9fe1a85ec53ULL;
+    result ^= (result >> 33);
     return result;
 }
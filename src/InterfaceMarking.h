@@ -24,12 +24,19 @@
 #include "types.h"
 
 
+/// how many 64 bit words an interface marking may store without allocating memory
+#define INLINE_WORDS 2
+
+
 /*!
   \brief an interface marking
 
   Interface markings are stored as a mapping from an input/output label to
   integer numbers that range from 0 to the message bound. To save space,
-  several numbers are stored within a byte when possible.
+  several numbers are stored within a byte when possible. The bytes are
+  padded to whole 64 bit words, so markings are compared and hashed word by
+  word. If the words fit into the object itself (see INLINE_WORDS), no
+  further memory is allocated; this is decided once by initialize().
 
   The set(), inc(), and dec() operator check whether the stored values stay
   in their bounds and return false if they detect a problem (i.e. violation
@@ -47,20 +54,34 @@
         order to display the marking count in a stream operator. The
         operator<< does this voluntarily.
 
-  \todo see http://c-faq.com/misc/bitsets.html for possible improvements --
-        especially using preprocessor macros
+  \note The word, offset, and mask of each label are calculated by
+        initialize(), so accessing a label needs neither divisions nor
+        branches. A value never spans two bytes, and all accesses read and
+        write whole words.
 */
 class InterfaceMarking {
         friend class Diagnosis;
+        friend class Knowledge;
         friend class LivelockOperatingGuideline;
+        friend class StoredKnowledge;
+
+    private: /* types */
+        /// the position of a label's value inside the word array
+        struct Field {
+            /// the word in which the value is stored
+            uint8_t word;
+
+            /// the offset inside the word, i.e. the starting position
+            uint8_t offset;
+
+            /// the bits of the word that store the value
+            uint64_t mask;
+        };
 
     public: /* static functions */
         /// initializes the class InterfaceMarking
         static void initialize();
 
-        /// sorts a given vector of interface markings
-        static void sort(std::vector<InterfaceMarking*>&);
-
     private: /* static attributes */
         /// the message bound
         static uint8_t message_bound;
@@ -77,6 +98,15 @@ class InterfaceMarking {
         /// how many markings can be stored in one byte
         static uint8_t markings_per_byte;
 
+        /// how many 64 bit words are needed to store an interface marking
+        static uint8_t words;
+
+        /// whether the words are stored inline (i.e., words <= INLINE_WORDS)
+        static bool inline_storage;
+
+        /// the position of each label's value (indexed by label)
+        static std::vector<Field> fields;
+
     public: /* member functions */
         /// constructor
         InterfaceMarking();
@@ -134,11 +164,38 @@ class InterfaceMarking {
         /// returns true if value and the value for the given label are equal
         bool isEqual(const uint8_t& value, const Label_ID& label) const;
 
+        /// exchanges the values with the given marking
+        void swap(InterfaceMarking&);
+
     private: /* member functions */
+        /// constructor for markings whose word array is owned by someone else
+        InterfaceMarking(uint64_t*, const InterfaceMarking*);
+
         /// returns the marking value for the given label
         uint8_t get(const Label_ID&) const;
 
+        /// sets all values to 0
+        inline void clear();
+
+        /// copies the values of the given marking
+        inline void copy(const InterfaceMarking&);
+
+        /// returns the words storing the marking
+        inline uint64_t* data() {
+            return inline_storage ? local : storage;
+        }
+
+        /// returns the words storing the marking
+        inline const uint64_t* data() const {
+            return inline_storage ? local : storage;
+        }
+
     private: /* member attributes */
-        /// a byte array to store the interface markings
-        uint8_t* storage;
+        union {
+            /// a word array to store the interface markings
+            uint64_t* storage;
+
+            /// the interface markings if they fit into the object
+            uint64_t local[INLINE_WORDS];
+        };
 };
@@ -18,11 +18,13 @@
 \*****************************************************************************/
 
 #include <iostream>
-#include <set>
+#include <algorithm>
 #include <cassert>
-#include <sstream>
 #include <pnapi/pnapi.h>
 #include "InnerMarking.h"
+#include "Label.h"
+#include "Cover.h"
+#include "Output.h"
 #include "util.h"
 #include "InternalReduction.h"
 #include "cmdline.h"
@@ -30,6 +32,9 @@
 
 extern gengetopt_args_info args_info;
 
+/// a file to store a mapping from marking ids to actual Petri net markings
+extern Output* markingoutput;
+
 extern int reducedgraph_parse();
 extern int reducedgraph_lex_destroy();
 extern FILE* reducedgraph_in;
@@ -38,7 +43,6 @@ extern FILE* reducedgraph_in;
 #define TAU 0
 
 using pnapi::Transition;
-typedef std::pair<std::set<unsigned int>::iterator, bool> ii;
 
 Graph* Graph::g;
 unsigned int Graph::r1 = 0;
@@ -47,8 +51,34 @@ unsigned int Graph::r62 = 0;
 unsigned int Graph::r63 = 0;
 
 
+/// whether the sorted edge list contains the given edge
+inline bool hasEdge(const std::vector<GraphEdge>& edges, const GraphEdge& e) {
+    return std::binary_search(edges.begin(), edges.end(), e);
+}
+
+/// insert an edge into a sorted edge list; returns false if it was present
+inline bool insertEdge(std::vector<GraphEdge>& edges, const GraphEdge& e) {
+    std::vector<GraphEdge>::iterator it = std::lower_bound(edges.begin(), edges.end(), e);
+    if (it != edges.end() and *it == e) {
+        return false;
+    }
+    edges.insert(it, e);
+    return true;
+}
+
+/// remove an edge from a sorted edge list
+inline void eraseEdge(std::vector<GraphEdge>& edges, const GraphEdge& e) {
+    std::vector<GraphEdge>::iterator it = std::lower_bound(edges.begin(), edges.end(), e);
+    if (it != edges.end() and *it == e) {
+        edges.erase(it);
+    }
+}
+
+
+Graph::Graph() : size(0) {}
+
 void Graph::shortInfo() {
-    message("   N=%d, R1=%d, R2=%d, R6.2=%d, R6.3=%d", nodes.size(), r1, r2, r62, r63);
+    message("   N=%d, R1=%d, R2=%d, R6.2=%d, R6.3=%d", size, r1, r2, r62, r63);
 }
 
 void Graph::info() {
@@ -56,13 +86,15 @@ void Graph::info() {
     unsigned int t = 0;
 
     FOREACH(n, nodes) {
-        FOREACH(l, n->second->postset) {
-            e += l->second.size();
+        if (*n) {
+            e += (*n)->postset.size();
+            for (size_t i = 0; i < (*n)->postset.size() and (*n)->postset[i].first == TAU; ++i) {
+                ++t;
+            }
         }
-        t += n->second->postset[TAU].size();
     }
 
-    message("   N=%d, E=%d, τ=%d, R1=%d, R2=%d, R6.2=%d, R6.3=%d", nodes.size(), e, t, r1, r2, r62, r63);
+    message("   N=%d, E=%d, τ=%d, R1=%d, R2=%d, R6.2=%d, R6.3=%d", size, e, t, r1, r2, r62, r63);
 }
 
 void Graph::initLabels() {
@@ -111,267 +143,194 @@ void Graph::initLabels() {
     }
 }
 
-void Graph::addEdge(unsigned int source, unsigned int target, const char* label) {
-    const unsigned int labelNum = labels[label];
-
-    GraphNode* s = nodes[source];
-    GraphNode* t = nodes[target];
-
-    if (not s) {
-        s = nodes[source] = new GraphNode();
+/// the node with the given id (created if not present yet)
+GraphNode* Graph::node(unsigned int n) {
+    if (n >= nodes.size()) {
+        nodes.resize(n + 1, NULL);
     }
-    if (not t) {
-        t = nodes[target] = new GraphNode();
+    if (not nodes[n]) {
+        nodes[n] = new GraphNode();
+        ++size;
     }
+    return nodes[n];
+}
+
+void Graph::addEdge(unsigned int source, unsigned int target, const char* label) {
+    const unsigned int labelNum = labels[label];
 
-    ii ii1 = t->preset[labelNum].insert(source);
-    s->postset[labelNum].insert(target);
+    GraphNode* const s = node(source);
+    GraphNode* const t = node(target);
 
-    if (not ii1.second) {
+    if (not insertEdge(t->preset, GraphEdge(labelNum, source))) {
         r1++;
     }
+    insertEdge(s->postset, GraphEdge(labelNum, target));
 }
 
-void Graph::addFinal(unsigned int node) {
-    GraphNode* n = nodes[node];
-    assert(n);
-    n->isFinal = true;
+void Graph::addFinal(unsigned int n) {
+    node(n)->isFinal = true;
 }
 
-Output* Graph::out() {
-    Output* temp = new Output();
-
-    FOREACH(n1, orderedNodes) {
-        const GraphNode* v1 = nodes[*n1];
-
-        temp->stream() << "STATE " << v1->dfs << " Lowlink: " << v1->lowlink << " " << v1->scc << "\n";
-
-        bool comma = false;
-        FOREACH(m, v1->markings) {
-            temp->stream() << (comma ? ",\n" : "");
-            temp->stream() << m->first << " : " << m->second;
-            if (not comma) {
-                comma = true;
-            }
-        }
-        temp->stream() << "\n\n";
-
-
-        FOREACH(l, v1->postset) {
-            FOREACH(n2, l->second) {
-                const GraphNode* v2 = nodes[*n2];
-
-                temp->stream() << labels2[l->first] << " -> " << v2->dfs << "\n";
-            }
-        }
-        temp->stream() << "\n";
+/*!
+ Creates the inner markings of the reduced graph in the order the
+ depth-first search of tarjan() finished them. This is the order in which
+ the parser of LoLA's output would create them, so all members of an SCC are
+ known when its representative is created. The identifiers of the inner
+ markings are the depth-first numbers.
+*/
+void Graph::createInnerMarkings() {
+    // translate the labels of the graph to the ids of class Label
+    std::vector<Label_ID> labelIds(labels2.empty() ? 0 : labels2.rbegin()->first + 1, 0);
+    FOREACH(l, labels2) {
+        labelIds[l->first] = Label::name2id[l->second];
     }
 
-    temp->stream() << std::flush;
-
-    return temp;
-}
+    FOREACH(n, orderedNodes) {
+        GraphNode* const v = nodes[*n];
 
+        std::vector<Label_ID> currentLabels;
+        std::vector<InnerMarking_ID> currentSuccessors;
+        std::set<std::string> currentTransitions;
 
+        FOREACH(e, v->postset) {
+            const Label_ID label = labelIds[e->first];
 
-bool Graph::metaRule() {
-    // look at all nodes...
-    FOREACH(n1, nodes) {
-        assert(nodes[n1->first]);
-
-        /**********\
-        * RULE 6.3 *
-        \**********/
-
-        // n1 (source) has exactly one outgoing edge, and that is a TAU edge
-        if (n1->second->postset.size() == 1 and n1->second->postset[TAU].size() == 1) {
-            unsigned int source = n1->first;
-            unsigned int target = *(n1->second->postset[TAU].begin());
-            assert(nodes[target]);
-
-//            if (args_info.debug_flag) {
-//                std::cerr << "[R6.3] merge nodes " << source << " and " << target << std::endl;
-//            }
-
-            // remove the linking tau-edge
-            removeEdge(source, target, TAU);
-
-            // merge the nodes (target remains)
-            mergeNode(target, source);
-
-            r63++;
-            return true;
-        }
-
-
-        // ... and their TAU-successors
-        FOREACH(n2, n1->second->postset[TAU]) {
-            unsigned int source = n1->first;
-            unsigned int target = *n2;
-            assert(nodes[target]);
-
-            /********\
-            * RULE 2 *
-            \********/
-
-            if (source != target and nodes[*n2]->postset[TAU].find(n1->first) != nodes[*n2]->postset[TAU].end()) {
-
-//                if (args_info.debug_flag) {
-//                    std::cerr << "[R2] merge nodes " << source << " and " << target << std::endl;
-//                }
-
-                // merge the nodes (source remains)
-                mergeNode(source, target);
-
-                // add tau loop
-                ii ii1 = n1->second->preset[TAU].insert(source);
-                n1->second->postset[TAU].insert(source);
-
-                if (not ii1.second) {
-                    r1++;
+            // a workaround for bug #14719
+            if (SYNC(label)) {
+                for (size_t i = 0; i < currentLabels.size(); ++i) {
+                    if (currentLabels[i] == label) {
+                        abort(17, "synchronous label '%s' of transition '%s' already used in this marking", Label::id2name[label].c_str(), labels2[e->first].c_str());
+                    }
                 }
-
-                r2++;
-                return true;
             }
 
+            currentLabels.push_back(label);
+            currentSuccessors.push_back(nodes[e->second]->dfs);
+            if (args_info.cover_given) {
+                currentTransitions.insert(labels2[e->first]);
+            }
+        }
 
-            /**********\
-            * RULE 6.2 *
-            \**********/
+        InnerMarking::markingMap[v->dfs] = new InnerMarking(v->dfs, currentLabels, currentSuccessors, v->isFinal);
 
-            bool possible = true;
+        if (markingoutput or args_info.cover_given) {
+            std::map<const pnapi::Place*, unsigned int> marking;
+            FOREACH(m, v->markings) {
+                marking[InnerMarking::net->findPlace(m->first)] = m->second;
+            }
 
-            FOREACH(l, labels) {
-                FOREACH(n3, n1->second->postset[l->second]) {
-                    if (*n3 != *n2) {
-                        if (nodes[*n2]->postset[l->second].find(*n3) == nodes[*n2]->postset[l->second].end()) {
-                            possible = false;
-                            break;
-                        }
+            if (markingoutput) {
+                markingoutput->stream() << v->dfs << ": ";
+                FOREACH(p, marking) {
+                    if (p != marking.begin()) {
+                        markingoutput->stream() << ", ";
                     }
+                    markingoutput->stream() << p->first->getName() << ":" << p->second;
                 }
+                markingoutput->stream() << "\n";
             }
 
-            if (possible) {
-//                if (args_info.debug_flag) {
-//                    std::cerr << "[R6.2] merge nodes " << source << " and " << target << std::endl;
-//                }
-
-                // remove the linking tau-edge
-                removeEdge(source, target, TAU);
-
-                // merge the nodes (source remains)
-                mergeNode(source, target);
-
-                r62++;
-                return true;
+            if (args_info.cover_given) {
+                Cover::checkInnerMarking(v->dfs, marking, currentTransitions);
             }
         }
+
+        InnerMarking::evaluateSCC(v->dfs, v->lowlink, v->scc);
     }
+}
 
-    return false;
+
+inline void Graph::enqueue(unsigned int n) {
+    if (not queued[n]) {
+        queued[n] = true;
+        worklist.push(n);
+    }
 }
 
+/*!
+ The rules checked on a node only depend on its postset and on the postsets
+ of its TAU-successors. Hence, if the postset of a node changed, the node
+ itself and its TAU-predecessors need to be checked again.
+*/
+inline void Graph::touch(unsigned int n) {
+    enqueue(n);
 
+    const std::vector<GraphEdge>& preset = nodes[n]->preset;
+    for (size_t i = 0; i < preset.size() and preset[i].first == TAU; ++i) {
+        enqueue(preset[i].second);
+    }
+}
 
 /*!
-\note Rule 6.3: Source node has exactly one outgoing edge, and that is a TAU edge.
+ Applies the first applicable rule to the given node (the source). The rules
+ are checked in the order 6.3, then 2 and 6.2 for each TAU-successor.
+
+ \return whether a rule was applied
 */
-bool Graph::rule63() {
-    FOREACH(n, nodes) {
-        // n (source) has exactly one outgoing edge, and that is a TAU edge
-        if (n->second->postset.size() == 1 and n->second->postset[TAU].size() == 1) {
-            unsigned int source = n->first;
-            unsigned int target = *(n->second->postset[TAU].begin());
+bool Graph::reduce(unsigned int source) {
+    const std::vector<GraphEdge>& postset = nodes[source]->postset;
 
-//            if (args_info.debug_flag) {
-//                std::cerr << "[R6.3] merge nodes " << source << " and " << target << std::endl;
-//            }
+    /**********\
+    * RULE 6.3 *
+    \**********/
 
-            // remove the linking tau-edge
-            removeEdge(source, target, TAU);
+    // source has exactly one outgoing edge, and that is a TAU edge
+    if (postset.size() == 1 and postset[0].first == TAU and postset[0].second != source) {
+        const unsigned int target = postset[0].second;
 
-            // merge the nodes (target remains)
-            mergeNode(target, source);
+        // remove the linking tau-edge
+        removeEdge(source, target, TAU);
 
-            r63++;
-            return true;
-        }
+        // merge the nodes (target remains)
+        mergeNode(target, source);
+
+        r63++;
+        return true;
     }
 
-    return false;
-}
+    // ... and its TAU-successors
+    for (size_t i = 0; i < postset.size() and postset[i].first == TAU; ++i) {
+        const unsigned int target = postset[i].second;
+        if (target == source) {
+            continue;
+        }
+        assert(nodes[target]);
 
-bool Graph::rule62() {
-    // look at all nodes...
-    FOREACH(n1, nodes) {
-        // ... and their TAU-successors
-        FOREACH(n2, n1->second->postset[TAU]) {
-            bool possible = true;
-
-            FOREACH(l, labels) {
-                FOREACH(n3, n1->second->postset[l->second]) {
-                    if (*n3 != *n2) {
-                        if (nodes[*n2]->postset[l->second].find(*n3) == nodes[*n2]->postset[l->second].end()) {
-                            possible = false;
-                            break;
-                        }
-                    }
-                }
-            }
+        /********\
+        * RULE 2 *
+        \********/
 
-            if (possible) {
-                unsigned int source = n1->first;
-                unsigned int target = *n2;
+        if (hasEdge(nodes[target]->postset, GraphEdge(TAU, source))) {
+            // merge the nodes (source remains); the linking tau-edges
+            // become a tau loop
+            mergeNode(source, target);
 
-//                if (args_info.debug_flag) {
-//                    std::cerr << "[R6.2] merge nodes " << source << " and " << target << std::endl;
-//                }
+            r2++;
+            return true;
+        }
 
-                // remove the linking tau-edge
-                removeEdge(source, target, TAU);
+        /**********\
+        * RULE 6.2 *
+        \**********/
 
-                // merge the nodes (source remains)
-                mergeNode(source, target);
+        bool possible = true;
 
-                r62++;
-                return true;
+        FOREACH(e, postset) {
+            if (e->second != target and not hasEdge(nodes[target]->postset, *e)) {
+                possible = false;
+                break;
             }
         }
-    }
 
-    return false;
-}
+        if (possible) {
+            // remove the linking tau-edge
+            removeEdge(source, target, TAU);
 
-// only implemented for trivial loops
-bool Graph::rule2() {
-    // look at all nodes...
-    FOREACH(n1, nodes) {
-        // ... and their TAU-successors
-        FOREACH(n2, n1->second->postset[TAU]) {
-            unsigned int source = n1->first;
-            unsigned int target = *n2;
-            if (source != target and nodes[*n2]->postset[TAU].find(n1->first) != nodes[*n2]->postset[TAU].end()) {
-
-//                if (args_info.debug_flag) {
-//                    std::cerr << "[R2] merge nodes " << source << " and " << target << std::endl;
-//                }
-
-                // merge the nodes (source remains)
-                mergeNode(source, target);
-
-                // add tau loop
-                ii ii1 = n1->second->preset[TAU].insert(source);
-                n1->second->postset[TAU].insert(source);
-
-                if (not ii1.second) {
-                    r1++;
-                }
+            // merge the nodes (source remains)
+            mergeNode(source, target);
 
-                r2++;
-                return true;
-            }
+            r62++;
+            return true;
         }
     }
 
@@ -379,63 +338,53 @@ bool Graph::rule2() {
 }
 
 inline void Graph::removeEdge(unsigned int source, unsigned int target, unsigned int label) {
-    nodes[source]->postset[label].erase(target);
-    nodes[target]->preset[label].erase(source);
+    eraseEdge(nodes[source]->postset, GraphEdge(label, target));
+    eraseEdge(nodes[target]->preset, GraphEdge(label, source));
 }
 
-inline void Graph::removeNode(unsigned int node) {
-    FOREACH(n, nodes) {
-        FOREACH(l, n->second->preset) {
-            l->second.erase(node);
-        }
-        FOREACH(l, n->second->postset) {
-            l->second.erase(node);
-        }
-    }
-
-    // remove
-//    delete nodes[node]; // would be expensive and useless
-    nodes[node] = NULL;
-    nodes.erase(nodes.find(node));
-    deleted.insert(node);
-}
+/*!
+ Moves all edges of node2 to node1 and removes node2. Only the neighbors of
+ node2 are visited. Afterwards, the changed nodes are put to the worklist.
 
-// node1 will remain
-// we may change node1 and node2 to assert 0 remains the initial node
-inline void Graph::mergeNode(unsigned int& node1, unsigned int& node2) {
-    // make sure 0 remains the initial node
+ \note The nodes are swapped if node2 is 0 to make sure 0 remains the
+       initial node.
+*/
+void Graph::mergeNode(unsigned int node1, unsigned int node2) {
     if (node2 == 0) {
-        unsigned int temp = node2;
-        node1 = node2;
-        node2 = temp;
+        std::swap(node1, node2);
     }
+    assert(node1 != node2);
 
     GraphNode* const n1 = nodes[node1];
     GraphNode* const n2 = nodes[node2];
     assert(n1);
     assert(n2);
 
-    // copy the postset of n2 to n1
-    FOREACH(l, n2->postset) {
-        FOREACH(t, l->second) {
-            ii ii1 = n1->postset[l->first].insert(*t);
-            nodes[*t]->preset[l->first].insert(node1);
+    // copy the postset of n2 to n1 (loops of n2 become loops of n1)
+    FOREACH(e, n2->postset) {
+        const unsigned int t = (e->second == node2) ? node1 : e->second;
 
-            if (not ii1.second) {
-                r1++;
-            }
+        if (not insertEdge(n1->postset, GraphEdge(e->first, t))) {
+            r1++;
+        }
+        insertEdge(nodes[t]->preset, GraphEdge(e->first, node1));
+        if (e->second != node2) {
+            eraseEdge(nodes[t]->preset, GraphEdge(e->first, node2));
         }
     }
 
-    FOREACH(l, n2->preset) {
-        FOREACH(t, l->second) {
-            ii ii1 = n1->preset[l->first].insert(*t);
-            nodes[*t]->postset[l->first].insert(node1);
+    // copy the preset of n2 to n1 (loops of n2 have been handled above)
+    FOREACH(e, n2->preset) {
+        if (e->second == node2) {
+            continue;
+        }
 
-            if (not ii1.second) {
-                r1++;
-            }
+        if (not insertEdge(n1->preset, GraphEdge(e->first, e->second))) {
+            r1++;
         }
+        GraphNode* const s = nodes[e->second];
+        insertEdge(s->postset, GraphEdge(e->first, node1));
+        eraseEdge(s->postset, GraphEdge(e->first, node2));
     }
 
     // don't reduce away final states
@@ -445,20 +394,27 @@ inline void Graph::mergeNode(unsigned int& node1, unsigned int& node2) {
     }
 
     // remove node2
-    removeNode(node2);
+    delete n2;
+    nodes[node2] = NULL;
+    --size;
+
+    // node1 and all predecessors of node1 got new postsets
+    touch(node1);
+    FOREACH(e, n1->preset) {
+        touch(e->second);
+    }
 }
 
 void Graph::tarjan(unsigned int v, bool firstCall) {
-    static std::stack<unsigned int> Tarj;
-    static std::set<unsigned int> Tarj_set;
+    static std::vector<unsigned int> Tarj;
+    static std::vector<bool> onStack;
+    static std::vector<bool> visited;
     static unsigned int maxdfs = 0;
-    static std::set<unsigned int> weiss;
 
     if (firstCall) {
         status("detecting SCCs");
-        FOREACH(n, nodes) {
-            weiss.insert(n->first);
-        }
+        onStack.assign(nodes.size(), false);
+        visited.assign(nodes.size(), false);
     }
 
     GraphNode* const n = nodes[v];
@@ -467,21 +423,20 @@ void Graph::tarjan(unsigned int v, bool firstCall) {
     n->lowlink = maxdfs;
     maxdfs += 1;
 
-    Tarj.push(v);
-    Tarj_set.insert(v);
-    weiss.erase(v);
-
-    FOREACH(l, n->postset) {
-        FOREACH(vprime, n->postset[l->first]) {
-            GraphNode* const nprime = nodes[*vprime];
-            assert(nprime);
-            if (weiss.find(*vprime) != weiss.end()) {
-                tarjan(*vprime, false);
-                n->lowlink = MINIMUM(n->lowlink, nprime->lowlink);
-            } else {
-                if (Tarj_set.find(*vprime) != Tarj_set.end()) {
-                    n->lowlink = MINIMUM(n->lowlink, nprime->dfs);
-                }
+    Tarj.push_back(v);
+    onStack[v] = true;
+    visited[v] = true;
+
+    FOREACH(e, n->postset) {
+        const unsigned int vprime = e->second;
+        GraphNode* const nprime = nodes[vprime];
+        assert(nprime);
+        if (not visited[vprime]) {
+            tarjan(vprime, false);
+            n->lowlink = MINIMUM(n->lowlink, nprime->lowlink);
+        } else {
+            if (onStack[vprime]) {
+                n->lowlink = MINIMUM(n->lowlink, nprime->dfs);
             }
         }
     }
@@ -489,116 +444,52 @@ void Graph::tarjan(unsigned int v, bool firstCall) {
     orderedNodes.push_back(v);
 
     if (n->lowlink == n->dfs) {
-        unsigned int count = 0;
-        std::stringstream ss;
         unsigned int vstar;
         do {
-            ++count;
-            vstar = Tarj.top();
-            Tarj_set.erase(vstar);
-            Tarj.pop();
+            vstar = Tarj.back();
+            onStack[vstar] = false;
+            Tarj.pop_back();
             if (vstar != v) {
-                ss << vstar << " ";
+                n->scc.insert(nodes[vstar]->dfs);
             }
         } while (vstar != v);
-
-        if (count > 1) {
-            n->scc = "SCC: " + ss.str();
-        }
     }
 }
 
 void Graph::addMarking(unsigned int n, const char* place, unsigned int tokens) {
-    GraphNode* state = nodes[n];
-    if (not state) {
-        state = nodes[n] = new GraphNode();
-    }
-    state->addMarking(place, tokens);
+    node(n)->addMarking(place, tokens);
 }
 
 inline void GraphNode::addMarking(const char* place, unsigned int tokens) {
     markings[place] = tokens;
 }
 
+/*!
+ Closes the gaps left by removed nodes. As the order of the nodes is kept,
+ the edge lists remain sorted.
+*/
 void Graph::reenumerate() {
-    // collect a sorted list of the nodenames
-    std::vector<unsigned int> nodeNames;
-    FOREACH(n, nodes) {
-        nodeNames.push_back(n->first);
-    }
-
-    for (size_t i = 0; i < nodeNames.size(); ++i) {
-        if (nodeNames[i] != i) {
-            assert(nodes[i] == NULL);
+    std::vector<unsigned int> translate(nodes.size(), 0);
+    std::vector<GraphNode*> remaining;
+    remaining.reserve(size);
 
-            // rename node in list
-            translate[nodeNames[i]] = i;
-            nodes[i] = nodes[nodeNames[i]];
-            nodes.erase(nodeNames[i]);
+    FOREACH(n, nodes) {
+        if (*n) {
+            translate[n - nodes.begin()] = remaining.size();
+            remaining.push_back(*n);
         }
     }
+    nodes.swap(remaining);
 
     status("reenumerating edges");
 
     // rename edges
-    FOREACH(n1, nodes) {
-        FOREACH(l, n1->second->postset) {
-            FOREACH(a, translate) {
-                if (l->second.erase(a->first) != 0) {
-                    l->second.insert(a->second);
-                }
-            }
-        }
-        FOREACH(l, n1->second->preset) {
-            FOREACH(a, translate) {
-                if (l->second.erase(a->first) != 0) {
-                    l->second.insert(a->second);
-                }
-            }
-        }
-    }
-}
-
-
-void Graph::reenumerate2() {
-    // collect a sorted list of the nodenames
-    std::vector<unsigned int> nodeNames;
     FOREACH(n, nodes) {
-        nodeNames.push_back(n->first);
-    }
-
-    std::set<unsigned int>::iterator freeSpace = deleted.begin();
-    for (size_t i = nodeNames.size(); i > 0; --i) {
-//        printf("checking %d\n", nodeNames[i-1]);
-        if (nodeNames[i - 1] != i and nodeNames[i - 1] > nodeNames.size()) {
-//            printf(" -> move to %d\n", *freeSpace);
-            translate[nodeNames[i - 1]] = *freeSpace;
-
-
-            // rename node in list
-            nodes[*freeSpace] = nodes[nodeNames[i - 1]];
-            nodes.erase(nodeNames[i - 1]);
-            ++freeSpace;
-        }
-    }
-
-    status("reenumerating edges (%lu/%lu)", translate.size(), nodes.size());
-
-    // rename edges
-    FOREACH(n1, nodes) {
-        FOREACH(l, n1->second->postset) {
-            FOREACH(a, translate) {
-                if (l->second.erase(a->first) != 0) {
-                    l->second.insert(a->second);
-                }
-            }
+        FOREACH(e, (*n)->preset) {
+            e->second = translate[e->second];
         }
-        FOREACH(l, n1->second->preset) {
-            FOREACH(a, translate) {
-                if (l->second.erase(a->first) != 0) {
-                    l->second.insert(a->second);
-                }
-            }
+        FOREACH(e, (*n)->postset) {
+            e->second = translate[e->second];
         }
     }
 }
@@ -606,23 +497,47 @@ void Graph::reenumerate2() {
 GraphNode::GraphNode() : lowlink(0), dfs(0), isFinal(false) {}
 
 
-Output* Graph::internalReduction(FILE* fullGraph) {
+void Graph::initialize() {
     g = new Graph();
     g->initLabels();
+}
+
+void Graph::internalReduction(FILE* fullGraph) {
+    initialize();
 
     reducedgraph_in = fullGraph;
     reducedgraph_parse();
     pclose(reducedgraph_in);
     reducedgraph_lex_destroy();
 
+    internalReduction();
+}
+
+void Graph::internalReduction() {
+    assert(g);
     g->info();
 
-    static unsigned int i = 0;
+    unsigned int i = 0;
     static const unsigned int j = 1000;
 
-    while (g->metaRule()) {
-        if (++i % j == 0) {
-            g->shortInfo();
+    // initially, all nodes need to be checked
+    g->queued.assign(g->nodes.size(), false);
+    for (unsigned int n = 0; n < g->nodes.size(); ++n) {
+        if (g->nodes[n]) {
+            g->enqueue(n);
+        }
+    }
+
+    while (not g->worklist.empty()) {
+        const unsigned int n = g->worklist.top();
+        g->worklist.pop();
+        g->queued[n] = false;
+
+        // skip nodes that have been merged meanwhile
+        if (g->nodes[n] and g->reduce(n)) {
+            if (++i % j == 0) {
+                g->shortInfo();
+            }
         }
     }
     g->info();
@@ -630,14 +545,13 @@ Output* Graph::internalReduction(FILE* fullGraph) {
     g->reenumerate();
     g->tarjan();
 
-    Output* result = g->out();
+    g->createInnerMarkings();
     delete g;
-    return result;
 }
 
 Graph::~Graph() {
     FOREACH(node, nodes) {
-        delete node->second;
-        node->second = NULL;
+        delete *node;
+        *node = NULL;
     }
 }
@@ -20,15 +20,28 @@
 #pragma once
 
 #include <map>
-#include <vector>
 #include <set>
+#include <vector>
+#include <queue>
+#include <functional>
 #include <string>
 #include <cstdio>
-#include "Output.h"
 
 
 class GraphNode;
 
+/// an edge seen from one of its nodes: the label and the adjacent node
+typedef std::pair<unsigned int, unsigned int> GraphEdge;
+
+/*!
+ \brief reachability graph of the inner of the net for the internal reduction
+
+ The reduction rules are applied until none of them is applicable anymore.
+ Instead of rescanning all nodes after each application, a worklist holds
+ the nodes whose neighborhood changed since a rule was last checked on them.
+ The worklist always yields the node with the smallest id, so the rules are
+ applied in the same order as a rescan from the first node would.
+*/
 class Graph {
     private:
         static unsigned int r1, r2, r63, r62;
@@ -37,7 +50,11 @@ class Graph {
         static Graph* g;
 
     private:
-        std::map<unsigned int, GraphNode*> nodes;
+        /// the nodes, indexed by their id (NULL for removed nodes)
+        std::vector<GraphNode*> nodes;
+
+        /// the number of nodes that have not been removed
+        unsigned int size;
 
         /// nodes, ordered during the depth-first search
         std::vector<unsigned int> orderedNodes;
@@ -46,38 +63,43 @@ class Graph {
         std::map<std::string, unsigned int> labels;
         std::map<unsigned int, std::string> labels2;
 
-        /// a mapping to organize the reenumeration
-        std::map<unsigned int, unsigned int> translate;
+        /// the nodes on which the reduction rules need to be checked
+        std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int> > worklist;
 
-        /// the ids of deleted nodes (used to reenumerate)
-        std::set<unsigned int> deleted;
+        /// whether a node is in the worklist
+        std::vector<bool> queued;
 
-        void mergeNode(unsigned int&, unsigned int&);
-        void renameNode(unsigned int, unsigned int);
-        void removeNode(unsigned int);
+        GraphNode* node(unsigned int);
+        void mergeNode(unsigned int, unsigned int);
         void removeEdge(unsigned int, unsigned int, unsigned int);
+        void touch(unsigned int);
+        void enqueue(unsigned int);
 
         void tarjan(unsigned int = 0, bool = true);
 
-        void init();
         void initLabels();
-        Output* out();
+        void createInnerMarkings();
         void shortInfo();
         void info();
         void reenumerate();
-        void reenumerate2();
 
-        bool metaRule();
-        bool rule2();
-        bool rule63();
-        bool rule62();
+        bool reduce(unsigned int);
 
     public:
+        Graph();
+
         void addEdge(unsigned int, unsigned int, const char*);
         void addMarking(unsigned int, const char*, unsigned int);
         void addFinal(unsigned int);
 
-        static Output* internalReduction(FILE* fullGraph);
+        /// create an empty graph g to be filled by the built-in state space generator
+        static void initialize();
+
+        /// read the graph from a LoLA state space, reduce it, and create the inner markings
+        static void internalReduction(FILE* fullGraph);
+
+        /// reduce the graph g and create the inner markings
+        static void internalReduction();
         ~Graph();
 };
 
@@ -85,8 +107,11 @@ class GraphNode {
     public:
         GraphNode();
 
-        std::map<unsigned int, std::set<unsigned int> > preset;
-        std::map<unsigned int, std::set<unsigned int> > postset;
+        /// the incoming edges, sorted by label and source (TAU edges first)
+        std::vector<GraphEdge> preset;
+
+        /// the outgoing edges, sorted by label and target (TAU edges first)
+        std::vector<GraphEdge> postset;
 
         /// the lowlink value (calculated by depth-first search)
         unsigned int lowlink;
@@ -94,7 +119,10 @@ class GraphNode {
         /// the depth-first number
         unsigned int dfs;
 
-        std::string scc;
+        /// the depth-first numbers of the other members of the SCC (only
+        /// stored for the representative)
+        std::set<unsigned int> scc;
+
         std::map<std::string, unsigned int> markings;
 
         bool isFinal;
@@ -19,8 +19,12 @@
 
 
 #include <config.h>
-#include <set>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
 #include "Knowledge.h"
+#include "Statistics.h"
+#include "StoredKnowledge.h"
 #include "cmdline.h"
 #include "util.h"
 
@@ -33,21 +37,24 @@ extern gengetopt_args_info args_info;
  ***************/
 
 Knowledge::Knowledge(InnerMarking_ID m)
-    : is_sane(1), posSendEventsDecoded(NULL), size(1), bubble(), todo(),
-      posSendEvents(NULL),
+    : is_sane(1), size(0), bubble(), arena(),
+      arenaCapacity(16), arenaUsed(0), table(), hashes(), todo(),
+      posSendEvents(),
       consideredReceivingEvents(Label::receive_events, false),
       //my_id(maxid),
-      minReceiveMessages(NULL),
-      minSendMessages(NULL){
+      minSendMessages(NULL),
+      minReceiveMessages(NULL) {
+    Statistics::created(Statistics::KNOWLEDGE);
+
     // add this marking to the bubble and the todo queue
-    InterfaceMarking* empty = new InterfaceMarking();
-    bubble[m].push_back(empty);
+    InterfaceMarking* empty = allocate();
+    insert(m, empty);
     todo.push(m, empty);
 
     //++maxid;
 
     // check if initial marking is already bad
-    if (InnerMarking::inner_markings[m]->is_bad) {
+    if (InnerMarking::isBad(m)) {
         is_sane = 0;
         return;
     }
@@ -55,40 +62,47 @@ Knowledge::Knowledge(InnerMarking_ID m)
     // calculate the closure
     closure();
 
+    sort();
     initialize();
 }
 
 
 /*!
- \note no action in this constructor can introduce a duplicate
+ \note The first block of the arena, the bubble, and the hash table are sized
+       for as many markings as the parent knowledge has.
 */
 Knowledge::Knowledge(const Knowledge* parent, const Label_ID& label)
-    : is_sane(1), posSendEventsDecoded(NULL), size(0), posSendEvents(NULL),
+    : is_sane(1), size(0), bubble(), arena(),
+      arenaCapacity(parent->size < 16 ? 16 : parent->size), arenaUsed(0), table(), hashes(), todo(),
+      posSendEvents(),
       consideredReceivingEvents(Label::receive_events, false),
       //my_id(maxid),
-      minReceiveMessages(NULL),
-      minSendMessages(NULL){
+      minSendMessages(NULL),
+      minReceiveMessages(NULL) {
+    Statistics::created(Statistics::KNOWLEDGE);
+
     // tau does not make sense here
     assert(not SILENT(label));
 
+    bubble.reserve(parent->size);
+    hashes.reserve(parent->size);
+    size_t slots = 16;
+    while (slots < 2 * static_cast<size_t>(parent->size)) {
+        slots *= 2;
+    }
+    table.assign(slots, 0);
+
     //++maxid;
     // CASE 1: we receive -- decrement interface markings
     if (RECEIVING(label)) {
         FOREACH(pos, parent->bubble) {
-            for (size_t i = 0; i < pos->second.size(); ++i) {
-                // copy an interface marking from the parent and decrement it
-                bool result = true;
-                InterfaceMarking* interface = new InterfaceMarking(*(pos->second[i]), label, false, result);
-
-                // analyze the result of the copying
-                if (result) {
-                    // store this interface marking
-                    bubble[pos->first].push_back(interface);
-                    ++size;
-                } else {
-                    // decrement failed -- remove this (unreachable) interface marking
-                    delete interface;
-                }
+            // copy an interface marking from the parent and decrement it
+            InterfaceMarking* interface = allocate(pos->interface);
+
+            // analyze the result of the decrement
+            if (not interface->dec(label) or not insert(pos->inner, interface)) {
+                // decrement failed -- remove this (unreachable) interface marking
+                release();
             }
         }
     }
@@ -97,29 +111,29 @@ Knowledge::Knowledge(const Knowledge* parent, const Label_ID& label)
     if (SENDING(label)) {
         FOREACH(pos, parent->bubble) {
             // check if this label makes the current inner marking possibly transient
-            bool receiver = (InnerMarking::receivers[label].find(pos->first) != InnerMarking::receivers[label].end());
-
-            for (size_t i = 0; i < pos->second.size(); ++i) {
-                // copy an interface marking from the parent and increment it
-                bool result = true;
-                InterfaceMarking* interface = new InterfaceMarking(*(pos->second[i]), label, true, result);
-                is_sane = is_sane and result;
-
-                // analyze the result of the copying
-                if (result or args_info.diagnose_given) {
-                    // store this interface marking
-                    bubble[pos->first].push_back(interface);
-                    ++size;
-
-                    // success -- possibly, this marking became transient
-                    if (receiver and result) {
-                        todo.push(pos->first, interface);
-                    }
-                } else {
-                    // increment failed -- message bound violation
-                    delete interface;
-                    return;
+            const bool receiver = InnerMarking::activatedBy(pos->inner, label);
+
+            // copy an interface marking from the parent and increment it
+            InterfaceMarking* interface = allocate(pos->interface);
+            const bool result = interface->inc(label);
+            is_sane = is_sane and result;
+
+            // analyze the result of the increment
+            if (result or args_info.diagnose_given) {
+                // store this interface marking
+                if (not insert(pos->inner, interface)) {
+                    release();
+                    continue;
+                }
+
+                // success -- possibly, this marking became transient
+                if (receiver and result) {
+                    todo.push(pos->inner, interface);
                 }
+            } else {
+                // increment failed -- message bound violation
+                release();
+                return;
             }
         }
 
@@ -131,27 +145,28 @@ Knowledge::Knowledge(const Knowledge* parent, const Label_ID& label)
     if (SYNC(label)) {
         FOREACH(pos, parent->bubble) {
             // check if this label makes the current inner marking possibly transient
-            if ((InnerMarking::synchs[label].find(pos->first) != InnerMarking::synchs[label].end())) {
-
-                for (size_t i = 0; i < pos->second.size(); ++i) {
-                    // copy the interface marking (won't change during synchronization)
-                    InterfaceMarking* interface = new InterfaceMarking(*(pos->second[i]));
-
-                    InnerMarking* m = InnerMarking::inner_markings[pos->first];
-                    for (uint8_t j = 0; j < m->out_degree; ++j) {
-                        if (m->labels[j] == label) {
-                            // check the marking reached by synchronization
-                            if (InnerMarking::inner_markings[m->successors[j]]->is_bad) {
-                                is_sane = 0;
-                                if (not args_info.diagnose_given) {
-                                    delete interface;
-                                    return;
-                                }
+            if (InnerMarking::activatedBy(pos->inner, label)) {
+                const InnerMarking_ID* successors = InnerMarking::successorIds(pos->inner);
+                const Label_ID* labels = InnerMarking::successorLabels(pos->inner);
+                const uint8_t out_degree = InnerMarking::outDegree(pos->inner);
+                for (uint8_t j = 0; j < out_degree; ++j) {
+                    if (labels[j] == label) {
+                        // check the marking reached by synchronization
+                        if (InnerMarking::isBad(successors[j])) {
+                            is_sane = 0;
+                            if (not args_info.diagnose_given) {
+                                return;
                             }
-                            // the marking is OK and new, so add it to the bubble
-                            todo.push(m->successors[j], interface);
-                            bubble[m->successors[j]].push_back(interface);
-                            ++size;
+                        }
+
+                        // copy the interface marking (won't change during synchronization)
+                        InterfaceMarking* interface = allocate(pos->interface);
+
+                        // if the marking is new, add it to the bubble
+                        if (insert(successors[j], interface)) {
+                            todo.push(successors[j], interface);
+                        } else {
+                            release();
                         }
                     }
                 }
@@ -162,19 +177,73 @@ Knowledge::Knowledge(const Knowledge* parent, const Label_ID& label)
         closure();
     }
 
+    sort();
     initialize();
 }
 
 
+/*!
+ A stored knowledge holds all markings of the knowledge it was built from,
+ so the closure is not calculated again and the markings need not be
+ checked for duplicates.
+
+ \note This constructor is used by StoredKnowledge::processNodeParallel to
+       keep only the stored knowledges whose successors are still to be
+       calculated. It takes a reference, so it cannot be confused with the
+       constructor for an inner marking (e.g., Knowledge(0)).
+*/
+Knowledge::Knowledge(const StoredKnowledge& SK)
+    : is_sane(SK.is_sane), size(SK.sizeAllMarkings), bubble(), arena(),
+      arenaCapacity(SK.sizeAllMarkings < 16 ? 16 : SK.sizeAllMarkings), arenaUsed(0), table(), hashes(), todo(),
+      posSendEvents(),
+      consideredReceivingEvents(Label::receive_events, false),
+      //my_id(maxid),
+      minSendMessages(NULL),
+      minReceiveMessages(NULL) {
+    Statistics::created(Statistics::KNOWLEDGE);
+
+    bubble.reserve(size);
+    for (innermarkingcount_t i = 0; i < size; ++i) {
+        BubbleMarking marking = { SK.inner[i], allocate(SK.interface + i) };
+        bubble.push_back(marking);
+    }
+
+    sort();
+    initialize();
+}
+
+
+/*!
+ \param[in] SK  a stored knowledge
+
+ \return a new knowledge with the markings of SK (to be deleted by the caller)
+*/
+Knowledge* Knowledge::fromStored(const StoredKnowledge* SK) {
+    assert(SK);
+    return new Knowledge(*SK);
+}
+
+
+/*!
+ \note The interface markings in the arena are not destructed, because their
+       byte arrays are part of the arena, too.
+*/
 Knowledge::~Knowledge() {
-    // delete the stored interface markings
-    FOREACH(pos, bubble) {
-        for (size_t i = 0; i < pos->second.size(); ++i) {
-            delete pos->second[i];
-        }
+    FOREACH(block, arena) {
+        free(*block);
     }
+}
+
+
+/*************
+ * OPERATORS *
+ *************/
 
-    delete posSendEvents;
+bool BubbleMarking::operator< (const BubbleMarking& other) const {
+    if (inner != other.inner) {
+        return (inner < other.inner);
+    }
+    return (*interface < *other.interface);
 }
 
 
@@ -206,11 +275,9 @@ void Knowledge::setMinMessages(){
 
 		//calculate the minimal number for each receive message in the bubble
 		FOREACH(pos, bubble){
-			for (size_t i = 0; i < pos->second.size(); ++i) {
-				for(Label_ID l = Label::first_receive; l < Label::last_receive + 1; ++l){
-					current_pos = l - Label::first_receive;
-					minReceiveMessages[current_pos] = pos->second[i]->getMin(minReceiveMessages[current_pos],l);
-				}
+			for(Label_ID l = Label::first_receive; l < Label::last_receive + 1; ++l){
+				current_pos = l - Label::first_receive;
+				minReceiveMessages[current_pos] = pos->interface->getMin(minReceiveMessages[current_pos],l);
 			}
 		}
 	}
@@ -226,27 +293,24 @@ void Knowledge::setMinMessages(){
 	bool consider;
 	FOREACH(pos, bubble){
 
-		for (size_t i = 0; i < pos->second.size(); ++i) {
-
-			consider = true;
+		consider = true;
 
-			//do we need consider the current interface marking?
-			for(Label_ID l = Label::first_receive; l < Label::last_receive + 1; ++l){
+		//do we need consider the current interface marking?
+		for(Label_ID l = Label::first_receive; l < Label::last_receive + 1; ++l){
 
-				assert(minReceiveMessages != NULL);
-				current_pos = l - Label::first_receive;
+			assert(minReceiveMessages != NULL);
+			current_pos = l - Label::first_receive;
 
-				if (not pos->second[i]->isEqual(minReceiveMessages[current_pos],l)){
-					consider = false;
-//					break;
-				}
+			if (not pos->interface->isEqual(minReceiveMessages[current_pos],l)){
+				consider = false;
+//				break;
 			}
+		}
 
-			if(consider){
-				for(Label_ID l = Label::first_send; l < Label::last_send + 1; ++l){
-					current_pos = l - Label::first_send;
-					minSendMessages[current_pos] = pos->second[i]->getMin(minSendMessages[current_pos],l);
-				}
+		if(consider){
+			for(Label_ID l = Label::first_send; l < Label::last_send + 1; ++l){
+				current_pos = l - Label::first_send;
+				minSendMessages[current_pos] = pos->interface->getMin(minSendMessages[current_pos],l);
 			}
 		}
 	}
@@ -271,29 +335,25 @@ void Knowledge::initialize() {
 
 
     // reduction rule: smart sending event
-    // OG: create array of those sending events that are possible in _all_ markings of the current bubble
+    // OG: collect those sending events that are possible in _all_ markings of the current bubble
     // OG: initially, every sending event is possible
-    // TG: create array of those sending events that are possible in at least one marking of the current bubble
-    // TG: initially, none sending event is possible
-    posSendEvents = new PossibleSendEvents(true, 1);
-
+    // TG: collect those sending events that are possible in at least one marking of the current bubble
+    // TG: initially, none sending event is possible (see constructor)
     if(not args_info.tg_given){
+        posSendEvents.setTrue();
+
     	// traverse each marking of the current bubble
     	FOREACH(pos, bubble) {
     		// use boolean AND to detect which sending event is possible in each and every marking of the current bubble
-    		*posSendEvents &= *(InnerMarking::inner_markings[pos->first]->possibleSendEvents);
+    		posSendEvents &= InnerMarking::sendEvents(pos->inner);
     	}
     }
     else{
         // traverse each marking of the current bubble
         FOREACH(pos, bubble) {
-            *posSendEvents |= *(InnerMarking::inner_markings[pos->first]->possibleSendEvents);
+            posSendEvents |= InnerMarking::sendEvents(pos->inner);
         }
     }
-
-    // create array to be used when traversing all events
-    posSendEventsDecoded = posSendEvents->decode();
-
 }
 
 
@@ -308,83 +368,184 @@ void Knowledge::closure() {
     // process the queue
     while (InterfaceMarking* current_interface = todo.popInterface()) {
         // process successors of the current marking
-        InnerMarking* m = InnerMarking::inner_markings[todo.popInner()];
+        const InnerMarking_ID m = todo.popInner();
+        const InnerMarking_ID* successors = InnerMarking::successorIds(m);
+        const Label_ID* labels = InnerMarking::successorLabels(m);
+        const uint8_t out_degree = InnerMarking::outDegree(m);
 
         // check, if each sent message contained on the interface of this marking will ever be consumed
-        if (not args_info.ignoreUnreceivedMessages_flag and not m->sentMessagesConsumed(*current_interface) and not args_info.tg_given) {
+        if (not args_info.ignoreUnreceivedMessages_flag and not InnerMarking::sentMessagesConsumed(m, *current_interface) and not args_info.tg_given) {
             is_sane = 0;
             if (not args_info.diagnose_given) {
                 return;
             }
         }
 
-        for (uint8_t i = 0; i < m->out_degree; ++i) {
+        for (uint8_t i = 0; i < out_degree; ++i) {
             // a synchronization is impossible without the environment -- skip
-            if (SYNC(m->labels[i])) {
+            if (SYNC(labels[i])) {
                 continue;
             }
 
             // in any case, create a successor candidate -- it will be valid
-            // for transient transitions anyway
-            InnerMarking_ID candidate_inner = m->successors[i];
-            InterfaceMarking* candidate_interface = new InterfaceMarking(*current_interface);
+            // for transient transitions anyway; the candidate is built in
+            // place and given back to the arena unless it is new
+            InnerMarking_ID candidate_inner = successors[i];
+            InterfaceMarking* candidate_interface = allocate(current_interface);
 
             // we receive -> the net sends
-            if (RECEIVING(m->labels[i])) {
+            if (RECEIVING(labels[i])) {
                 // message bound violation?
-                if (not candidate_interface->inc(m->labels[i])) {
+                if (not candidate_interface->inc(labels[i])) {
                     is_sane = 0;
                     if (not args_info.diagnose_given) {
-                        delete candidate_interface;
+                        release();
                         return;
                     }
                 }
             }
 
             // we send -> the net receives
-            if (SENDING(m->labels[i])) {
-                if (not candidate_interface->dec(m->labels[i])) {
+            if (SENDING(labels[i])) {
+                if (not candidate_interface->dec(labels[i])) {
                     // this marking is not reachable
-                    delete candidate_interface;
+                    release();
                     continue;
                 }
             }
 
             // check if successor is a deadlock or livelock
-            if (InnerMarking::inner_markings[candidate_inner]->is_bad) {
+            if (InnerMarking::isBad(candidate_inner)) {
                 is_sane = 0;
                 if (not args_info.diagnose_given) {
-                    delete candidate_interface;
+                    release();
                     return;
                 }
             }
 
-            // if we found a valid successor candidate, check if it is already stored
-            bool candidateFound = false;
-            for (size_t j = 0; j < bubble[candidate_inner].size(); ++j) {
-                if (*(bubble[candidate_inner][j]) == *candidate_interface) {
-                    candidateFound = true;
-                    delete candidate_interface;
-                    break;
-                }
-            }
-            if (not candidateFound) {
-                bubble[candidate_inner].push_back(candidate_interface);
-                ++size;
+            // if we found a valid successor candidate, store it unless it is already stored
+            if (insert(candidate_inner, candidate_interface)) {
                 todo.push(candidate_inner, candidate_interface);
 
-                // sort bubble using self-implemented quicksort
-                InterfaceMarking::sort(bubble[candidate_inner]);
-
                 if (not is_sane) {
                     return;
                 }
+            } else {
+                release();
             }
         }
     }
 }
 
 
+/*!
+ \param[in] other  the interface marking to copy; if NULL, the new marking
+                   is empty
+
+ \return an interface marking stored in the arena; it stays valid until the
+         knowledge is destructed
+
+ \note When the last block of the arena is full, a block twice its size is
+       allocated. The size of the first block is the expected number of
+       markings given by the constructor.
+*/
+InterfaceMarking* Knowledge::allocate(const InterfaceMarking* other) {
+    // the size of an interface marking together with its word array (if not stored inline)
+    const size_t recordSize = sizeof(InterfaceMarking) +
+        (InterfaceMarking::inline_storage ? 0 : InterfaceMarking::words * sizeof(uint64_t));
+
+    if (arena.empty() or arenaUsed == arenaCapacity) {
+        if (not arena.empty()) {
+            arenaCapacity *= 2;
+        }
+        arena.push_back(static_cast<uint8_t*>(malloc(arenaCapacity * recordSize)));
+        assert(arena.back());
+        arenaUsed = 0;
+    }
+
+    uint8_t* record = arena.back() + (arenaUsed++) * recordSize;
+    return new (record) InterfaceMarking(reinterpret_cast<uint64_t*>(record + sizeof(InterfaceMarking)), other);
+}
+
+
+/*!
+ \pre The interface marking allocated last is not used any more.
+*/
+void Knowledge::release() {
+    assert(arenaUsed > 0);
+    --arenaUsed;
+}
+
+
+/*!
+ \param[in] inner      an inner marking
+ \param[in] interface  an interface marking stored in the arena
+
+ \return whether the marking was added to the bubble, i.e., whether it was
+         not already present
+
+ \note The hash value of each marking is stored, so markings are only
+       compared if their hash values are equal, and the table grows without
+       hashing the markings again.
+*/
+bool Knowledge::insert(const InnerMarking_ID& inner, InterfaceMarking* interface) {
+    // keep the load factor below 1/2
+    if (2 * (size + 1) > table.size()) {
+        grow();
+    }
+
+    const hash_t hash = (interface->hash() ^ inner) * 1099511628211ULL;
+    const size_t mask = table.size() - 1;
+    size_t slot = hash & mask;
+    while (table[slot] != 0) {
+        const innermarkingcount_t other = table[slot] - 1;
+        if (hashes[other] == hash and bubble[other].inner == inner and
+            *bubble[other].interface == *interface) {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    BubbleMarking marking = { inner, interface };
+    bubble.push_back(marking);
+    hashes.push_back(hash);
+    table[slot] = ++size;
+
+    return true;
+}
+
+
+/*!
+ Sorts the markings of the bubble by inner marking and then by interface
+ marking, because equal knowledges must store their markings in the same
+ order.
+
+ \post The hash table and the hash values are released, so no further
+       markings can be added.
+*/
+void Knowledge::sort() {
+    std::sort(bubble.begin(), bubble.end());
+    std::vector<innermarkingcount_t>().swap(table);
+    std::vector<hash_t>().swap(hashes);
+}
+
+
+void Knowledge::grow() {
+    std::vector<innermarkingcount_t> newTable(table.empty() ? 16 : 2 * table.size(), 0);
+    const size_t mask = newTable.size() - 1;
+
+    for (innermarkingcount_t i = 0; i < size; ++i) {
+        size_t slot = hashes[i] & mask;
+        while (newTable[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        newTable[slot] = i + 1;
+    }
+
+    table.swap(newTable);
+}
+
+
 /*!
  \return whether the knowledge contains a waitstate that can be resolved by
          label l (synchronous or send)
@@ -393,7 +554,7 @@ bool Knowledge::resolvableWaitstate(const Label_ID& l) const {
     assert(not RECEIVING(l));
 
     FOREACH(pos, bubble) {
-        if (InnerMarking::inner_markings[pos->first]->waitstate(l)) {
+        if (InnerMarking::waitstate(pos->inner, l)) {
             return true;
         }
     }
@@ -406,38 +567,34 @@ bool Knowledge::resolvableWaitstate(const Label_ID& l) const {
          receiving these messages is sufficient and no sending is required
 */
 bool Knowledge::receivingHelps() const {
-    // traverse the inner markings
+    // traverse the markings
     FOREACH(pos, bubble) {
         // only consider non-final waitstates
-        if (InnerMarking::inner_markings[pos->first]->is_waitstate) {
-
-            // traverse the interface markings
-            for (size_t i = 0; i < pos->second.size(); ++i) {
-
-                // check if waitstate is resolved by interface marking
-                bool resolved = false;
-                for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-                    if (pos->second[i]->marked(l) and
-                            InnerMarking::receivers[l].find(pos->first) != InnerMarking::receivers[l].end()) {
-                        resolved = true;
-                        break;
-                    }
-                }
-                if (resolved) {
-                    continue;
+        if (InnerMarking::isWaitstate(pos->inner)) {
+
+            // check if waitstate is resolved by interface marking
+            bool resolved = false;
+            for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
+                if (pos->interface->marked(l) and
+                        InnerMarking::activatedBy(pos->inner, l)) {
+                    resolved = true;
+                    break;
                 }
+            }
+            if (resolved) {
+                continue;
+            }
 
-                // check if waitstate marks an output place
-                bool marked = false;
-                for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
-                    if (pos->second[i]->marked(l)) {
-                        marked = true;
-                    }
-                }
-                if (not marked) {
-                    return false;
+            // check if waitstate marks an output place
+            bool marked = false;
+            for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
+                if (pos->interface->marked(l)) {
+                    marked = true;
                 }
             }
+            if (not marked) {
+                return false;
+            }
         }
     }
 
@@ -455,7 +612,7 @@ bool Knowledge::isWaitstateInCurrentKnowledge(const InnerMarking_ID& inner, cons
     // check if waitstate is resolved by interface marking
     for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
         if (interface->marked(l) and
-                InnerMarking::receivers[l].find(inner) != InnerMarking::receivers[l].end()) {
+                InnerMarking::activatedBy(inner, l)) {
             return false;
         }
     }
@@ -475,40 +632,36 @@ void Knowledge::sequentializeReceivingEvents() {
     std::vector<uint8_t> occuranceOfReceivingEvent(Label::receive_events + 1, 0);
 
     // remember to consider this state again; actually we only need to take a look at its interface
-    std::set<InterfaceMarking*> visitStateAgain;
+    std::vector<const InterfaceMarking*> visitStateAgain;
 
-    // traverse the inner markings
+    // traverse the markings
     FOREACH(pos, bubble) {
         // only consider non-final waitstates
-        if (InnerMarking::inner_markings[pos->first]->is_waitstate) {
-
-            // traverse the interface markings
-            for (size_t i = 0; i < pos->second.size(); ++i) {
-
-                if (isWaitstateInCurrentKnowledge(pos->first, pos->second[i])) {
-                    // check if waitstate marks an output place
-                    Label_ID marked = 0;
-                    Label_ID consideredReceivingEvent = 0;
-
-                    for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
-                        if (pos->second[i]->marked(l)) {
-                            // remember that current receiving event is activated in a waitstate
-                            ++occuranceOfReceivingEvent[l];
-                            // remember this event in case the current waitstate activates only one receiving event
-                            consideredReceivingEvent = l;
-                            ++marked;
-                        }
-                    }
-                    // check if waitstate activates only a single receiving event
-                    if (marked == 1) {
-                        // this receiving event has to be considered
-                        consideredReceivingEvents[consideredReceivingEvent - 1] = true;
-                    }
+        if (InnerMarking::isWaitstate(pos->inner)) {
 
-                    // remember to visit this state again; we only store the
-                    // interface here, we don't need more information later on
-                    visitStateAgain.insert(pos->second[i]);
+            if (isWaitstateInCurrentKnowledge(pos->inner, pos->interface)) {
+                // check if waitstate marks an output place
+                Label_ID marked = 0;
+                Label_ID consideredReceivingEvent = 0;
+
+                for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
+                    if (pos->interface->marked(l)) {
+                        // remember that current receiving event is activated in a waitstate
+                        ++occuranceOfReceivingEvent[l];
+                        // remember this event in case the current waitstate activates only one receiving event
+                        consideredReceivingEvent = l;
+                        ++marked;
+                    }
+                }
+                // check if waitstate activates only a single receiving event
+                if (marked == 1) {
+                    // this receiving event has to be considered
+                    consideredReceivingEvents[consideredReceivingEvent - 1] = true;
                 }
+
+                // remember to visit this state again; we only store the
+                // interface here, we don't need more information later on
+                visitStateAgain.push_back(pos->interface);
             }
         }
     }
@@ -583,7 +736,6 @@ bool Knowledge::considerReceivingEvent(const Label_ID& label) const {
 */
 bool Knowledge::considerSendingEvent(const Label_ID& label) const {
     assert(not args_info.ignoreUnreceivedMessages_flag);
-    assert(posSendEventsDecoded);
 
-    return (posSendEventsDecoded[label - Label::first_send] == 1);
+    return posSendEvents.possible(label);
 }
@@ -20,12 +20,28 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include "Label.h"
 #include "InnerMarking.h"
 #include "Queue.h"
 
-typedef std::map<InnerMarking_ID, std::vector<InterfaceMarking*> > Bubble;
+
+class StoredKnowledge;
+
+
+/// a marking of a knowledge bubble
+struct BubbleMarking {
+    /// the inner marking
+    InnerMarking_ID inner;
+
+    /// the interface marking (stored in the arena of the knowledge)
+    InterfaceMarking* interface;
+
+    /// comparison operator (by inner marking, then by interface marking)
+    bool operator< (const BubbleMarking&) const;
+};
+
+/// the markings of a knowledge bubble (sorted once the knowledge is built)
+typedef std::vector<BubbleMarking> Bubble;
 
 
 /*!
@@ -34,6 +50,14 @@ typedef std::map<InnerMarking_ID, std::vector<InterfaceMarking*> > Bubble;
  This class is used to build knowledges. Its main focus is runtime
  optimization. A later translation into StoredKnowledge objects removes any
  unnecessary information, yielding a compact representation.
+
+ The interface markings of a knowledge are not allocated one by one, but
+ taken from an arena owned by the knowledge: a few blocks of memory, each
+ holding a number of interface markings together with their byte arrays.
+ Candidates for new markings are built in place at the end of the arena and
+ given back if they turn out to be invalid or already known. Duplicates are
+ detected with a hash table of the bubble's markings. Hence, building a
+ knowledge only needs a constant number of allocations on average.
 */
 class Knowledge {
         friend class StoredKnowledge;
@@ -42,6 +66,9 @@ class Knowledge {
         /// construct knowledge from (initial) inner marking
         explicit Knowledge(InnerMarking_ID);
 
+        /// rebuild a knowledge from its compactly stored version
+        static Knowledge* fromStored(const StoredKnowledge*);
+
         /// destructor
         ~Knowledge();
 
@@ -52,6 +79,9 @@ class Knowledge {
         /// construct knowledge from a given knowledge and a label
         Knowledge(const Knowledge*, const Label_ID&);
 
+        /// rebuild a knowledge from its compactly stored version (see fromStored())
+        explicit Knowledge(const StoredKnowledge&);
+
         /// whether the knowledge contains a waitstate resolvable by l
         bool resolvableWaitstate(const Label_ID&) const;
 
@@ -76,28 +106,55 @@ class Knowledge {
         /// inner marking is really waitstate in the context of the current knowledge
         inline bool isWaitstateInCurrentKnowledge(const InnerMarking_ID& inner, const InterfaceMarking* interface) const;
 
+        /// returns a new interface marking from the arena (a copy of the given marking or empty)
+        inline InterfaceMarking* allocate(const InterfaceMarking* = NULL);
+
+        /// gives the most recently allocated interface marking back to the arena
+        inline void release();
+
+        /// adds a marking to the bubble unless it is already present
+        inline bool insert(const InnerMarking_ID&, InterfaceMarking*);
+
+        /// doubles the size of the hash table
+        void grow();
+
+        /// sorts the markings of the bubble
+        void sort();
+
     public: /* attributes */
         /// whether this knowledge is sane
         unsigned is_sane : 1;
 
     private: /* attributes */
-        /// reduction rule: smart send events; array of sending events that are either possible or not
-        char* posSendEventsDecoded;
-
         /// \brief the number of markings stored in the bubble
         innermarkingcount_t size;
 
         /// primary data structure
         Bubble bubble;
 
+        /// the blocks of the arena in which the interface markings are stored
+        std::vector<uint8_t*> arena;
+
+        /// the number of interface markings the last block of the arena can hold (or the first block will hold)
+        size_t arenaCapacity;
+
+        /// the number of interface markings stored in the last block of the arena
+        size_t arenaUsed;
+
+        /// hash table to find markings in the bubble (positions + 1; 0 marks an empty slot)
+        std::vector<innermarkingcount_t> table;
+
+        /// the hash values of the markings in the bubble (same positions as the bubble)
+        std::vector<hash_t> hashes;
+
         //static unsigned int maxid; //for test guidelines
         //unsigned int my_id; //for test guidelines
 
         /// a queue of markings to be processed by closure()
         Queue todo;
 
-        /// reduction rule: smart send events; pointer to possible sending events data structure
-        PossibleSendEvents* posSendEvents;
+        /// reduction rule: smart send events; the sending events that are possible
+        PossibleSendEvents posSendEvents;
 
         /// reduction rule: sequentialize receiving events; remember only those receiving events
         ///                 which are essential to resolve each and every waitstate
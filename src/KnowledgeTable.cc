@@ -0,0 +1,218 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <cassert>
+#include <cstdlib>
+#include "KnowledgeTable.h"
+#include "StoredKnowledge.h"
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+size_t KnowledgeTable::initial_capacity = 1024;
+float KnowledgeTable::maximal_load_factor = 0.8;
+
+
+/******************************
+ * CONSTRUCTOR AND DESTRUCTOR *
+ ******************************/
+
+/*!
+ \note The slots are allocated with calloc, so every slot is initially free.
+*/
+KnowledgeTable::KnowledgeTable()
+    : collisions(0), resizes(0),
+      slots(static_cast<Slot*>(calloc(initial_capacity, sizeof(Slot)))),
+      mask(initial_capacity - 1), entries(0) {
+    assert(slots);
+    assert((initial_capacity & mask) == 0);
+}
+
+
+KnowledgeTable::~KnowledgeTable() {
+    free(slots);
+}
+
+
+/********************
+ * MEMBER FUNCTIONS *
+ ********************/
+
+/*!
+ The hash values of the knowledges are not necessarily well distributed in
+ their lower bits, so they are mixed (finalizer of MurmurHash3) before the
+ slot is chosen.
+*/
+size_t KnowledgeTable::home(const hash_t& h) const {
+    uint64_t x = h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x) & mask;
+}
+
+
+/*!
+ \param[in] pos       the slot to start probing
+ \param[in] h         the hash value of the entry
+ \param[in] SK        the knowledge of the entry
+ \param[in] distance  the distance of pos to the home slot of the entry
+
+ \note Whenever the probed slot holds an entry that is closer to its home
+       slot than the entry to place, the two entries are swapped and the
+       displaced entry is placed further on.
+*/
+void KnowledgeTable::place(size_t pos, hash_t h, StoredKnowledge* SK, size_t distance) {
+    while (slots[pos].knowledge != NULL) {
+        const size_t other = (pos - home(slots[pos].hash)) & mask;
+
+        if (other < distance) {
+            const hash_t temp_hash = slots[pos].hash;
+            StoredKnowledge* const temp_knowledge = slots[pos].knowledge;
+
+            slots[pos].hash = h;
+            slots[pos].knowledge = SK;
+
+            h = temp_hash;
+            SK = temp_knowledge;
+            distance = other;
+        }
+
+        pos = (pos + 1) & mask;
+        ++distance;
+    }
+
+    slots[pos].hash = h;
+    slots[pos].knowledge = SK;
+}
+
+
+void KnowledgeTable::grow() {
+    Slot* const old_slots = slots;
+    const size_t old_capacity = mask + 1;
+
+    slots = static_cast<Slot*>(calloc(2 * old_capacity, sizeof(Slot)));
+    assert(slots);
+    mask = 2 * old_capacity - 1;
+    ++resizes;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].knowledge != NULL) {
+            place(home(old_slots[i].hash), old_slots[i].hash, old_slots[i].knowledge, 0);
+        }
+    }
+
+    free(old_slots);
+}
+
+
+/*!
+ \param[in] SK  the knowledge to look up or store
+ \param[in] h   the hash value of SK
+
+ \return a pointer to a knowledge stored in the table -- it is either SK if
+         no equal knowledge was stored before or a pointer to the previously
+         stored knowledge
+*/
+StoredKnowledge* KnowledgeTable::insert(StoredKnowledge* const SK, const hash_t& h) {
+    assert(SK);
+
+    size_t pos = home(h);
+    size_t distance = 0;
+
+    // search the probe sequence; it ends at a free slot or at an entry that
+    // is closer to its home slot than we are to ours
+    while (slots[pos].knowledge != NULL and
+            ((pos - home(slots[pos].hash)) & mask) >= distance) {
+        // only compare the markings if the hash values are equal
+        if (slots[pos].hash == h) {
+            if (slots[pos].knowledge->equals(SK)) {
+                return slots[pos].knowledge;
+            }
+
+            // the same hash value for different knowledges
+            ++collisions;
+        }
+
+        pos = (pos + 1) & mask;
+        ++distance;
+    }
+
+    // the knowledge is new -- make room for it if necessary
+    if (entries + 1 > maximal_load_factor * (mask + 1)) {
+        grow();
+        place(home(h), h, SK, 0);
+    } else {
+        place(pos, h, SK, distance);
+    }
+
+    ++entries;
+    return SK;
+}
+
+
+StoredKnowledge* KnowledgeTable::operator[](const size_t i) const {
+    assert(i <= mask);
+    return slots[i].knowledge;
+}
+
+
+size_t KnowledgeTable::capacity() const {
+    return mask + 1;
+}
+
+
+size_t KnowledgeTable::size() const {
+    return entries;
+}
+
+
+float KnowledgeTable::loadFactor() const {
+    return static_cast<float>(entries) / static_cast<float>(mask + 1);
+}
+
+
+/*!
+ \param[out] maximal  the maximal distance of an entry to its home slot
+ \param[out] average  the average distance of an entry to its home slot
+
+ \note A distance of 0 means that an entry is found without probing.
+*/
+void KnowledgeTable::probeLengths(size_t& maximal, float& average) const {
+    size_t sum = 0;
+    maximal = 0;
+
+    for (size_t i = 0; i <= mask; ++i) {
+        if (slots[i].knowledge != NULL) {
+            const size_t distance = (i - home(slots[i].hash)) & mask;
+            sum += distance;
+            if (distance > maximal) {
+                maximal = distance;
+            }
+        }
+    }
+
+    average = entries ? static_cast<float>(sum) / static_cast<float>(entries) : 0;
+}
@@ -0,0 +1,110 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include "types.h"
+
+class StoredKnowledge;
+
+
+/*!
+ \brief hash table of stored knowledges
+
+ The knowledges are stored in a single array of slots (open addressing with
+ linear probing). Insertion follows the Robin Hood scheme: an entry that is
+ farther away from its home slot than the entry it probes takes over that
+ slot, and the displaced entry continues probing. This keeps probe sequences
+ short even at high load factors and allows a lookup to stop as soon as it
+ meets an entry that is closer to its home slot than the searched one.
+
+ Each slot caches the hash value of its knowledge. Knowledges are only
+ compared marking by marking if their hash values coincide, and the table
+ can be resized without recalculating any hash value.
+*/
+class KnowledgeTable {
+    public: /* static attributes */
+        /// the number of slots of a new table (must be a power of two)
+        static size_t initial_capacity;
+
+        /// the load factor at which the table doubles its capacity
+        static float maximal_load_factor;
+
+    public: /* member functions */
+        /// constructor
+        KnowledgeTable();
+
+        /// destructor (does not delete the stored knowledges)
+        ~KnowledgeTable();
+
+        /// returns a stored knowledge equal to the given one, or stores and returns the given one
+        StoredKnowledge* insert(StoredKnowledge* const, const hash_t&);
+
+        /// returns the knowledge stored in the given slot (NULL if the slot is free)
+        StoredKnowledge* operator[](const size_t) const;
+
+        /// returns the number of slots
+        size_t capacity() const;
+
+        /// returns the number of stored knowledges
+        size_t size() const;
+
+        /// returns the ratio of used slots
+        float loadFactor() const;
+
+        /// determines the maximal and average distance of the entries to their home slot
+        void probeLengths(size_t&, float&) const;
+
+    private: /* member functions */
+        /// returns the home slot of a hash value
+        inline size_t home(const hash_t&) const;
+
+        /// moves an entry into the table starting at the given slot (Robin Hood insertion)
+        inline void place(size_t, hash_t, StoredKnowledge*, size_t);
+
+        /// doubles the capacity and reinserts all entries
+        void grow();
+
+    public: /* member attributes */
+        /// the number of compared knowledges with equal hash values that turned out to be different
+        unsigned int collisions;
+
+        /// the number of times the table was resized
+        unsigned int resizes;
+
+    private: /* member attributes */
+        /// a slot of the table
+        struct Slot {
+            /// the hash value of the stored knowledge
+            hash_t hash;
+
+            /// the stored knowledge (NULL if the slot is free)
+            StoredKnowledge* knowledge;
+        };
+
+        /// the slots (length is mask + 1)
+        Slot* slots;
+
+        /// the capacity minus one (the capacity is a power of two)
+        size_t mask;
+
+        /// the number of stored knowledges
+        size_t entries;
+};
@@ -27,6 +27,7 @@
 #include "AnnotationLivelockOG.h"
 #include "LivelockOperatingGuideline.h"
 #include "CompositeMarking.h"
+#include "StronglyConnectedSets.h"
 #include "Clause.h"
 #include "verbose.h"
 #include "cmdline.h"
@@ -34,7 +35,6 @@
 
 LivelockOperatingGuideline::_stats LivelockOperatingGuideline::stats;
 AnnotationLivelockOG LivelockOperatingGuideline::annotationLivelockOG = AnnotationLivelockOG();
-unsigned int LivelockOperatingGuideline::maxDFS = 0;
 
 extern gengetopt_args_info args_info;
 
@@ -56,136 +56,6 @@ void LivelockOperatingGuideline::initialize() {
 
 
 
-/*!
-  Tarjan's algorithm to find SCCs within all nodes (consisting of SCCs themselves) contained in the TS
-  \param toBeVisited the set of knowledges to be traversed
-  \param setOfSCCs a set of strongly connected components
- */
-bool LivelockOperatingGuideline::getSCCs(const std::set<StoredKnowledge* > & toBeVisited,
-                                         SetOfSCCs& setOfSCCs) {
-
-    // reset tarjan stack (used in StoredKnowledge before)
-    StoredKnowledge::tarjanStack.clear();
-    StoredKnowledge::tarjanMapping.clear();
-
-    std::set<StoredKnowledge* > visited;
-
-    // go through the set of nodes that are to be visited
-    FOREACH(iter, toBeVisited) {
-        // we have not yet seen the node, find the SCCs of its reachability graph
-        getSCCsRecursively(*iter, visited, toBeVisited, setOfSCCs);
-    }
-
-    return true;
-}
-
-
-/*!
-  check if given knowledge is on the Tarjan stack (is a std::vector, so a find() does not help)
-  \param currentNode the knowledge that is to be checked
-  \return true, if knowledge is on the Tarjan stack; false, otherwise
-  \todo make an abstract data type (push, pop, find)
- */
-bool LivelockOperatingGuideline::findNodeInStack(const StoredKnowledge* currentNode) {
-
-    FOREACH(it, StoredKnowledge::tarjanStack) {
-        if (currentNode == *it) {
-            return true;
-        }
-    }
-    return false;
-}
-
-
-/*!
-   recursive function to find all strongly connected components within a given set of knowledges
-   \param currentNode currently considered knowledge
-   \param visited set of knowledges that have been visited already
-   \param toBeVisited set of knowledges that still need to be considered
-   \param setOfSCCs set of SCCs that have been found already
-
-   \todo check if we can get rid of the mapping (idea: inherit class LLStoredKnowledge from StoredKnowledge)
-   \todo implement a nice set<void*> with the _needed_ operators
-   \todo alternatively: store an "i'm in the set" bit at each object
- */
-bool LivelockOperatingGuideline::getSCCsRecursively(StoredKnowledge* currentNode,
-                                                    std::set<StoredKnowledge* > & visited,
-                                                    const std::set<StoredKnowledge* > & toBeVisited,
-                                                    SetOfSCCs& setOfSCCs) {
-
-    // remember, that we visited the current node
-    if (not visited.insert(currentNode).second) {
-        return true;
-    }
-
-    // adjust Tarjan values of the current node (first == dfs; second == lowlink)
-    StoredKnowledge::tarjanMapping[currentNode].first = StoredKnowledge::tarjanMapping[currentNode].second = maxDFS;
-
-    // increment depth number
-    ++maxDFS;
-
-    // put current node on Tarjan stack
-    StoredKnowledge::tarjanStack.push_back(currentNode);
-
-    // iterate over the successors of current node
-    for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-        if (currentNode->successors[l - 1] != NULL and currentNode->successors[l - 1] != StoredKnowledge::empty and
-                currentNode->successors[l - 1]->is_sane) {
-
-            // we have not yet touched the successor node and successor node is to be visited
-            // and if we should consider the edge
-            if (visited.find(currentNode->successors[l - 1]) == visited.end() and
-                    toBeVisited.find(currentNode->successors[l - 1]) != toBeVisited.end()) {
-
-                // do Tarjan algorithm for the successor state
-                getSCCsRecursively(currentNode->successors[l - 1], visited, toBeVisited, setOfSCCs);
-
-                // adjust lowlink value
-                StoredKnowledge::tarjanMapping[currentNode].second = MINIMUM(StoredKnowledge::tarjanMapping[currentNode].second,
-                                                                             StoredKnowledge::tarjanMapping[currentNode->successors[l - 1]].second);
-            } else {
-
-                // current node has been visited before, now check if it is still on the Tarjan stack
-                if (findNodeInStack(currentNode->successors[l - 1])) {
-
-                    // adjust lowlink value
-                    StoredKnowledge::tarjanMapping[currentNode].second = MINIMUM(StoredKnowledge::tarjanMapping[currentNode].second,
-                                                                                 StoredKnowledge::tarjanMapping[currentNode->successors[l - 1]].first);
-                }
-            }
-        }
-    }
-
-    // we have traversed through the reachability graph of the current node
-    // check, if the current node is a representative of a SCC
-    // if so, get all nodes within the SCC
-    if (StoredKnowledge::tarjanMapping[currentNode].first == StoredKnowledge::tarjanMapping[currentNode].second) {
-
-        // node which has just been popped from Tarjan stack
-        StoredKnowledge* poppedNode;
-        // current SCC
-        std::set<StoredKnowledge* > scc;
-        do {
-            if (StoredKnowledge::tarjanStack.empty()) {
-                continue;
-            }
-            // get last element
-            poppedNode = StoredKnowledge::tarjanStack.back();
-            // delete last element from stack
-            StoredKnowledge::tarjanStack.pop_back();
-            // put popped node into current SCC
-            scc.insert(poppedNode);
-
-        } while (currentNode != poppedNode);
-
-        // put newly found SCC into the set storing all SCCs
-        setOfSCCs.push_back(scc);
-    }
-
-    return true;
-}
-
-
 /*!
   given a set of stored knowledges generate the whole reachability tree of the markings stored within
   the knowledges and use Tarjan's algorithm to detect TSCCs
@@ -203,7 +73,7 @@ void LivelockOperatingGuideline::calculateTSCCInKnowledgeSet(const std::set<Stor
         for (innermarkingcount_t i = 0; i < (*iterSCS)->sizeAllMarkings; ++i) {
 
             // create new interface
-            InterfaceMarking* newInterface = new InterfaceMarking(*(*iterSCS)->interface[i]);
+            InterfaceMarking* newInterface = new InterfaceMarking((*iterSCS)->interface[i]);
 
             // check if we have seen the new marking already
             bool foundMarking;
@@ -211,7 +81,7 @@ void LivelockOperatingGuideline::calculateTSCCInKnowledgeSet(const std::set<Stor
 
             // if not, go on
             if (not foundMarking) {
-                calculateTSCCInKnowledgeSetRecursively(currentMarking, knowledgeSCS);
+                calculateTSCCInKnowledgeSetIteratively(currentMarking, knowledgeSCS);
             }
         }
     }
@@ -250,7 +120,7 @@ CompositeMarking* LivelockOperatingGuideline::getSuccessorMarking(const StoredKn
 
     for (innermarkingcount_t i = 0; i < storedKnowledge->sizeAllMarkings; ++i) {
 
-        if (storedKnowledge->inner[i] == innerMarking and(*storedKnowledge->interface[i] == *interface)) {
+        if (storedKnowledge->inner[i] == innerMarking and(storedKnowledge->interface[i] == *interface)) {
 
             CompositeMarking* foundMarking = CompositeMarkingsHandler::isVisited(storedKnowledge, innerMarking, interface, foundSuccessorMarking);
 
@@ -263,170 +133,207 @@ CompositeMarking* LivelockOperatingGuideline::getSuccessorMarking(const StoredKn
 
 
 /*!
-   recursive function to calculate all terminal strongly connected components within a given set of knowledges
+   calculates the successor of a composite marking at the given position: the positions up to the out degree of
+   the inner marking denote the steps internal to the current knowledge, the following positions denote the events
+   leading to successor knowledges within the given set of knowledges
 
    \note here the whole closure operation is done once again, i.e. given the current composite marking all of its
          successors within the current knowledge are calculated again; besides that also its successors in a successor
          knowledge are calculated
-   \param currentMarking composite marking that is considered now
+   \param currentMarking composite marking whose successor is calculated
+   \param position the position of the successor
    \param knowledgeSCS a set of knowledges
+   \param foundSuccessorMarking [out] successor marking has been visited before or not
+   \return the successor marking or NULL if there is no successor at the given position
  */
-void LivelockOperatingGuideline::calculateTSCCInKnowledgeSetRecursively(CompositeMarking* currentMarking,
-                                                                        const std::set<StoredKnowledge* > & knowledgeSCS) {
+CompositeMarking* LivelockOperatingGuideline::calculateSuccessorMarking(const CompositeMarking* currentMarking,
+                                                                        const unsigned int position,
+                                                                        const std::set<StoredKnowledge* > & knowledgeSCS,
+                                                                        bool& foundSuccessorMarking) {
 
+    // get successors of the inner marking of current marking
+    const InnerMarking_ID currentInner = currentMarking->innerMarking_ID;
+    const InnerMarking_ID* successors = InnerMarking::successorIds(currentInner);
+    const Label_ID* labels = InnerMarking::successorLabels(currentInner);
+    const uint8_t out_degree = InnerMarking::outDegree(currentInner);
 
-    assert(currentMarking != NULL);
+    foundSuccessorMarking = false;
 
-    // remember, that we visited the current node and set Tarjan values
-    CompositeMarkingsHandler::visitMarking(currentMarking);
-
-    // put current node on Tarjan stack
-    CompositeMarkingsHandler::tarjanStack.push_back(currentMarking);
-
-    // get inner marking of current marking
-    const InnerMarking* currentInner = InnerMarking::inner_markings[currentMarking->innerMarking_ID];
-
-    assert(currentInner != NULL);
-
-    // iterate over the successors of current inner marking --> steps internal to current knowledge
-    for (uint8_t j = 0; j < currentInner->out_degree; ++j) {
+    // steps internal to current knowledge
+    if (position < out_degree) {
+        const uint8_t j = position;
 
         // successor marking
         CompositeMarking* successorMarking = NULL;
 
-        // remember if the successor marking has been visited before
-        bool foundSuccessorMarking = false;
-
-        if (SYNC(currentInner->labels[j])) {
-            continue;
+        if (SYNC(labels[j])) {
+            return NULL;
         }
 
-        // First step: calculate successor marking
-
         // we need to calculate the interface of the successor marking
         InterfaceMarking* candidate_interface = NULL;
 
         // if a sending or receiving transition leaves current inner marking
-        if (RECEIVING(currentInner->labels[j]) or SENDING(currentInner->labels[j])) {
+        if (RECEIVING(labels[j]) or SENDING(labels[j])) {
 
             bool success = true;
 
             // it is a receiving event, but a sending transition leaves the inner marking ;-)
             // or if it is a sending event, a receiving transition leaves the inner marking
-            bool increase = RECEIVING(currentInner->labels[j]);
+            bool increase = RECEIVING(labels[j]);
 
-            candidate_interface = new InterfaceMarking(*(currentMarking->interface), currentInner->labels[j], increase, success);
+            candidate_interface = new InterfaceMarking(*(currentMarking->interface), labels[j], increase, success);
 
             // there was either a message bound violation or the interface has not been marked appropriately
             if (not success) {
                 delete candidate_interface;
 
-                continue;
+                return NULL;
             }
 
             // everything is fine, so get the successor marking
-            successorMarking = getSuccessorMarking(currentMarking->storedKnowledge, currentInner->successors[j], candidate_interface, foundSuccessorMarking);
+            successorMarking = getSuccessorMarking(currentMarking->storedKnowledge, successors[j], candidate_interface, foundSuccessorMarking);
 
-        } else if (SILENT(currentInner->labels[j])) { // tau step, interface is not touched
+        } else if (SILENT(labels[j])) { // tau step, interface is not touched
 
             candidate_interface = new InterfaceMarking(*(currentMarking->interface));
 
-            successorMarking = getSuccessorMarking(currentMarking->storedKnowledge, currentInner->successors[j], candidate_interface, foundSuccessorMarking);
+            successorMarking = getSuccessorMarking(currentMarking->storedKnowledge, successors[j], candidate_interface, foundSuccessorMarking);
         }
 
         if (successorMarking == NULL) {
             delete candidate_interface;
-
-            continue;
         }
 
-        // Second step: do Tarjan steps
+        return successorMarking;
+    }
 
-        if (not foundSuccessorMarking) {
-            // do Tarjan algorithm for the successor state
-            calculateTSCCInKnowledgeSetRecursively(successorMarking, knowledgeSCS);
+    // steps external to current knowledge
+    const Label_ID j = Label::first_receive + (position - out_degree);
 
-            // adjust lowlink value
-            currentMarking->lowlink = MINIMUM(currentMarking->lowlink, successorMarking->lowlink);
-        } else {
-            currentMarking->lowlink = MINIMUM(currentMarking->lowlink, successorMarking->dfs);
-        }
+    // do we actually have to consider the successor knowledge
+    if (currentMarking->storedKnowledge->successor(j) == NULL or
+            knowledgeSCS.find(currentMarking->storedKnowledge->successor(j)) == knowledgeSCS.end()) {
+
+        return NULL;
     }
 
-    if (knowledgeSCS.size() > 1) {
-        // iterate over the successors of current inner marking --> steps external to current knowledge
-        for (Label_ID j = Label::first_receive; j <= Label::last_sync; ++j) {
+    // successor marking
+    CompositeMarking* successorMarking = NULL;
 
-            // do we actually have to consider the successor knowledge
-            if (currentMarking->storedKnowledge->successors[j - 1] == NULL or
-                    knowledgeSCS.find(currentMarking->storedKnowledge->successors[j - 1]) == knowledgeSCS.end()) {
+    // we need to calculate the interface of the successor marking
+    InterfaceMarking* candidate_interface = NULL;
 
-                continue;
-            }
+    // receive message
+    if (RECEIVING(j) or SENDING(j)) {
 
-            // successor marking
-            CompositeMarking* successorMarking = NULL;
+        bool success = true;
+        bool increase = SENDING(j);
 
-            // remember if the successor marking has been visited before
-            bool foundSuccessorMarking = false;
+        candidate_interface = new InterfaceMarking(*currentMarking->interface, j, increase, success);
 
-            // First step: calculate successor marking
+        // there was either a message bound violation or the interface has not been marked appropriately
+        if (not success) {
+            delete candidate_interface;
 
-            // we need to calculate the interface of the successor marking
-            InterfaceMarking* candidate_interface = NULL;
+            return NULL;
+        }
 
-            // receive message
-            if (RECEIVING(j) or SENDING(j)) {
+        // everything is fine, so get the successor marking
+        successorMarking = getSuccessorMarking(currentMarking->storedKnowledge->successor(j), currentMarking->innerMarking_ID, candidate_interface, foundSuccessorMarking);
 
-                bool success = true;
-                bool increase = SENDING(j);
+    } else if (SYNC(j)) { // synch step
 
-                candidate_interface = new InterfaceMarking(*currentMarking->interface, j, increase, success);
+        candidate_interface = new InterfaceMarking(*currentMarking->interface);
 
-                // there was either a message bound violation or the interface has not been marked appropriately
-                if (not success) {
-                    delete candidate_interface;
+        for (Label_ID l = 0; l < out_degree; ++l) {
+            if (labels[l] == j) {
+                successorMarking = getSuccessorMarking(currentMarking->storedKnowledge->successor(j), successors[l], candidate_interface, foundSuccessorMarking);
+            }
+        }
+    }
 
-                    continue;
-                }
+    if (successorMarking == NULL) {
+        delete candidate_interface;
+    }
 
-                // everything is fine, so get the successor marking
-                successorMarking = getSuccessorMarking(currentMarking->storedKnowledge->successors[j - 1], currentMarking->innerMarking_ID, candidate_interface, foundSuccessorMarking);
+    return successorMarking;
+}
 
-            } else if (SYNC(j)) { // synch step
 
-                candidate_interface = new InterfaceMarking(*currentMarking->interface);
+/*!
+   calculates all terminal strongly connected components within a given set of knowledges that are reachable from
+   the given composite marking; Tarjan's algorithm is run with an explicit stack, so deep strongly connected sets
+   do not exhaust the call stack
 
-                for (Label_ID l = 0; l < currentInner->out_degree; ++l) {
-                    if (currentInner->labels[l] == j) {
-                        successorMarking = getSuccessorMarking(currentMarking->storedKnowledge->successors[j - 1], currentInner->successors[l], candidate_interface, foundSuccessorMarking);
-                    }
-                }
-            }
+   \param startMarking composite marking the search starts with
+   \param knowledgeSCS a set of knowledges
+ */
+void LivelockOperatingGuideline::calculateTSCCInKnowledgeSetIteratively(CompositeMarking* startMarking,
+                                                                        const std::set<StoredKnowledge* > & knowledgeSCS) {
 
-            if (successorMarking == NULL) {
-                delete candidate_interface;
+    assert(startMarking != NULL);
 
-                continue;
-            }
+    // the number of successor positions: all internal steps plus all events, if there is more than one knowledge
+    const unsigned int events = (knowledgeSCS.size() > 1) ? Label::last_sync - Label::first_receive + 1 : 0;
 
-            // Second step: do Tarjan steps
+    // remember, that we visited the start marking, set Tarjan values and put it on Tarjan stack
+    CompositeMarkingsHandler::visitMarking(startMarking);
+    CompositeMarkingsHandler::tarjanStack.push_back(startMarking);
 
-            // successor marking may be NULL in case a message bound violation is reached or there are not enough token on the
-            // interface in case of an receiving event
+    std::vector<Frame> search;
+    Frame start = { startMarking, 0, InnerMarking::outDegree(startMarking->innerMarking_ID) + events };
+    search.push_back(start);
 
-            if (not foundSuccessorMarking) {
-                // do Tarjan algorithm for the successor state
-                calculateTSCCInKnowledgeSetRecursively(successorMarking, knowledgeSCS);
+    while (not search.empty()) {
+        CompositeMarking* currentMarking = search.back().marking;
 
-                // adjust lowlink value
-                currentMarking->lowlink = MINIMUM(currentMarking->lowlink, successorMarking->lowlink);
-            } else {
+        // all successors have been considered: the marking is finished
+        if (search.back().position == search.back().positions) {
+            search.pop_back();
+
+            evaluateTSCC(currentMarking, knowledgeSCS);
 
-                currentMarking->lowlink = MINIMUM(currentMarking->lowlink, successorMarking->dfs);
+            // adjust lowlink value of the predecessor
+            if (not search.empty()) {
+                CompositeMarking* predecessor = search.back().marking;
+                predecessor->lowlink = MINIMUM(predecessor->lowlink, currentMarking->lowlink);
             }
+            continue;
+        }
+
+        // First step: calculate successor marking
+        bool foundSuccessorMarking = false;
+        CompositeMarking* successorMarking = calculateSuccessorMarking(currentMarking, search.back().position++, knowledgeSCS, foundSuccessorMarking);
+
+        if (successorMarking == NULL) {
+            continue;
+        }
+
+        // Second step: do Tarjan steps
+        if (not foundSuccessorMarking) {
+            // do Tarjan algorithm for the successor marking
+            CompositeMarkingsHandler::visitMarking(successorMarking);
+            CompositeMarkingsHandler::tarjanStack.push_back(successorMarking);
+
+            Frame successor = { successorMarking, 0, InnerMarking::outDegree(successorMarking->innerMarking_ID) + events };
+            search.push_back(successor);
+        } else {
+            currentMarking->lowlink = MINIMUM(currentMarking->lowlink, successorMarking->dfs);
         }
     }
+}
+
+
+/*!
+   checks whether a finished composite marking is the representative of a terminal strongly connected component;
+   if so, the markings of the component are taken from the Tarjan stack and the clause of the component is added
+
+   \param currentMarking composite marking whose successors have all been considered
+   \param knowledgeSCS a set of knowledges
+ */
+void LivelockOperatingGuideline::evaluateTSCC(CompositeMarking* currentMarking,
+                                              const std::set<StoredKnowledge* > & knowledgeSCS) {
 
     // check, if the current marking is a representative of a TSCC
     // if so, get all markings within the TSCC
@@ -538,85 +445,33 @@ void LivelockOperatingGuideline::generateLLOG() {
         return ;
     }
 
-    // set of nodes, fixed and non fixed ones used for calculating the set of connected components
-    std::set<StoredKnowledge* > fixedNodes;
-
-    getSCSRecursively(fixedNodes, StoredKnowledge::seen);
-
-    //fixedNodes.clear();
-    //seen.clear();
+    // enumerate the strongly connected sets and annotate each of them
+    StronglyConnectedSets::enumerate(StoredKnowledge::seen, processSCS);
 }
 
+
 /*!
-  recursive function to calculate all strongly connected sets within the set of knowledges
-  \param fixedNodes
-  \param nonFixedNodes
+  calculates the annotation of a strongly connected set
+  \param knowledgeSCS a strongly connected set of knowledges
+  \note Wendy aborts if more strongly connected sets than given by --scsLimit are found.
 */
-void LivelockOperatingGuideline::getSCSRecursively(std::set<StoredKnowledge* > & fixedNodes,
-                                                   std::set<StoredKnowledge* > & nonFixedNodes) {
-
-    // initialize Tarjan's value
-    maxDFS = 0;
-
-    // storage of the union of the fixed and non fixed nodes
-    std::set<StoredKnowledge* > unionFixedNodesNonFixedNodes;
+void LivelockOperatingGuideline::processSCS(const std::set<StoredKnowledge* > & knowledgeSCS) {
 
-    // calculate the union of the fixed and non fixed nodes and store it
-    std::set_union(fixedNodes.begin(), fixedNodes.end(),
-                   nonFixedNodes.begin(), nonFixedNodes.end(),
-                   std::insert_iterator<std::set<StoredKnowledge* > >(unionFixedNodesNonFixedNodes, unionFixedNodesNonFixedNodes.begin()));
+    ++stats.numberOfSCSs;
 
-
-    // calculate the SCCs using Tarjan of the given set of nodes
-    SetOfSCCs setOfSCCs;
-
-    getSCCs(unionFixedNodesNonFixedNodes, setOfSCCs);
-
-    if (setOfSCCs.empty()) {
-        return ;
+    // statistics output
+    if (args_info.reportFrequency_arg and stats.numberOfSCSs % args_info.reportFrequency_arg == 0) {
+        message("%8d SCSs", stats.numberOfSCSs);
     }
 
-    // traverse through all SCCs which are the strongly connected sets we are looking for ;-)
-    FOREACH(currentSCS, setOfSCCs) {
-        // if the set of fixed nodes is a subset of the current SCC we have found a real SCS
-        if (std::includes((*currentSCS).begin(), (*currentSCS).end(), fixedNodes.begin(), fixedNodes.end())) {
-
-            // statistics output
-            if (args_info.reportFrequency_arg and ++stats.numberOfSCSs % args_info.reportFrequency_arg == 0) {
-                message("%8d SCSs", stats.numberOfSCSs);
-            }
-
-            // calculate the reachability graph being spanned by the knowledges of the current SCS
-            // and search for the TSCC within
-            calculateTSCCInKnowledgeSet(*currentSCS);
-
-            std::set<StoredKnowledge* > f(fixedNodes);
-
-            std::set<StoredKnowledge* > n;
-            std::set_intersection(nonFixedNodes.begin(), nonFixedNodes.end(),
-                                  (*currentSCS).begin(), (*currentSCS).end(),
-                                  std::insert_iterator<std::set<StoredKnowledge* > >(n, n.begin()));
-
-            std::set<StoredKnowledge* > intersection(n);
-
-            // traverse through all elements of current SCC
-            FOREACH(iterSCC, intersection) {
-                n.erase(*iterSCC);
-
-                getSCSRecursively(f, n);
-
-                f.insert(*iterSCC);
-            }
-
-            n.clear();
-            f.clear();
-            intersection.clear();
-        }
+    if (args_info.scsLimit_arg and stats.numberOfSCSs > static_cast<unsigned int>(args_info.scsLimit_arg)) {
+        abort(19, "more than %d strongly connected sets (%d TSCCs calculated so far)",
+              args_info.scsLimit_arg, stats.numberOfTSCCInSCSs);
     }
 
-    // fixedNodes.clear();
-    // nonFixedNodes.clear();
-    setOfSCCs.clear();
+    // calculate the reachability graph being spanned by the knowledges of the current SCS
+    // and search for the TSCC within
+    calculateTSCCInKnowledgeSet(knowledgeSCS);
 }
 
 
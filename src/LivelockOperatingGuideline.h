@@ -28,9 +28,6 @@ class StoredKnowledge;
 class CompositeMarking;
 class AnnotationLivelockOG;
 
-/// set of strongly connected components over knowledges
-typedef std::vector<std::set<StoredKnowledge*> > SetOfSCCs;
-
 /*!
   does all the work when the livelock operating guideline shall be computed
   * calculate all SCSs within the reachable knowledges
@@ -41,6 +38,19 @@ typedef std::vector<std::set<StoredKnowledge*> > SetOfSCCs;
         is ensured by setting parameter --correctness=livelock
 */
 class LivelockOperatingGuideline {
+    private: /* types */
+        /// an entry of the depth-first search stack of calculateTSCCInKnowledgeSetIteratively()
+        struct Frame {
+            /// the composite marking
+            CompositeMarking* marking;
+
+            /// the position of the next successor to be considered
+            unsigned int position;
+
+            /// the number of successor positions of the marking
+            unsigned int positions;
+        };
+
     public: /* static attributes */
         /// struct combining the statistics on the class LivelockOperatingGuideline
         static struct _stats {
@@ -60,10 +70,6 @@ class LivelockOperatingGuideline {
         /// livelock operating guideline only: annotation of all strongly connected sets
         static AnnotationLivelockOG annotationLivelockOG;
 
-    private: /* static attributes */
-        /// maximal dfs value given so far when calculating livelock operating guideline (Tarjan)
-        static unsigned int maxDFS;
-
     public: /* static functions */
 
         static void initialize();
@@ -76,30 +82,26 @@ class LivelockOperatingGuideline {
 
     private: /* static functions */
 
-        /// get all strongly connected components of the given set of knowledges
-        inline static bool getSCCs(const std::set<StoredKnowledge* > & toBeVisited,
-                                   SetOfSCCs& setOfSCCs);
-
-        /// searches for the given knowledge in the Tarjan stack
-        inline static bool findNodeInStack(const StoredKnowledge* currentNode);
-
-        /// recursive function to get the strongly connected components
-        static bool getSCCsRecursively(StoredKnowledge* currentNode,
-                                       std::set<StoredKnowledge* > & visited,
-                                       const std::set<StoredKnowledge* > & toBeVisited,
-                                       SetOfSCCs& setOfSCCs);
-
-        /// recursive function to get the strongly connected sets
-        static void getSCSRecursively(std::set<StoredKnowledge* > & fixedNodes,
-                                      std::set<StoredKnowledge* > & nonFixedNodes);
+        /// calculates the annotation of a strongly connected set
+        static void processSCS(const std::set<StoredKnowledge* > & knowledgeSCS);
 
         /// get all terminal strongly connected components within the set of knowledges
         inline static void calculateTSCCInKnowledgeSet(const std::set<StoredKnowledge* > & knowledgeSCS);
 
-        /// recursive function to get all terminal strongly connected components
-        static void calculateTSCCInKnowledgeSetRecursively(CompositeMarking* currentMarking,
+        /// iterative function to get all terminal strongly connected components
+        static void calculateTSCCInKnowledgeSetIteratively(CompositeMarking* startMarking,
                                                            const std::set<StoredKnowledge* > & knowledgeSCS);
 
+        /// returns the successor of the given marking at the given position
+        inline static CompositeMarking* calculateSuccessorMarking(const CompositeMarking* currentMarking,
+                                                                  const unsigned int position,
+                                                                  const std::set<StoredKnowledge* > & knowledgeSCS,
+                                                                  bool& foundSuccessorMarking);
+
+        /// collects the terminal strongly connected component of the given marking (if any)
+        inline static void evaluateTSCC(CompositeMarking* currentMarking,
+                                        const std::set<StoredKnowledge* > & knowledgeSCS);
+
         /// returns the pointer to the marking that corresponds to the given parameters
         inline static CompositeMarking* getSuccessorMarking(const StoredKnowledge* storedKnowledge,
                                                             const InnerMarking_ID innerMarking,
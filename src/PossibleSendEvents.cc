@@ -20,10 +20,9 @@
 
 #include <config.h>
 #include <cstdlib>
+#include <cstring>
 
 #include "PossibleSendEvents.h"
-#include "InterfaceMarking.h"
-#include "Label.h"
 #include "cmdline.h"
 #include "verbose.h"
 
@@ -34,7 +33,8 @@ extern gengetopt_args_info args_info;
  * STATIC MEMBERS *
  ******************/
 
-uint8_t PossibleSendEvents::bytes = 0;
+uint8_t PossibleSendEvents::words = 0;
+bool PossibleSendEvents::inline_storage = true;
 
 
 /******************
@@ -42,8 +42,9 @@ uint8_t PossibleSendEvents::bytes = 0;
  ******************/
 
 void PossibleSendEvents::initialize() {
-    bytes = ((Label::send_events - 1) / 8) + 1;
-    status("send event detection requires %d bytes per inner marking", bytes);
+    words = (Label::send_events / 64) + 1;
+    inline_storage = (words <= INLINE_WORDS);
+    status("send event detection requires %d words per inner marking", words);
 }
 
 
@@ -53,11 +54,16 @@ void PossibleSendEvents::initialize() {
 
 /*
   \brief all values are initialized with 0
-  \note we assume sizeof(uint8_t) == 1
 */
-PossibleSendEvents::PossibleSendEvents()
-    : storage((uint8_t*)calloc(bytes, 1)), decodedLabels(NULL) {
-    assert(bytes > 0);
+PossibleSendEvents::PossibleSendEvents() {
+    assert(words > 0);
+
+    if (not inline_storage) {
+        storage = static_cast<uint64_t*>(calloc(words, sizeof(uint64_t)));
+        assert(storage);
+    } else {
+        setFalse();
+    }
 }
 
 /*
@@ -66,19 +72,21 @@ PossibleSendEvents::PossibleSendEvents()
                  otherwise if allValues is set to false, label represents the
                  label that is to be set to one, all others are initialized
                  with 0
-  \note we assume sizeof(uint8_t) == 1
 */
-PossibleSendEvents::PossibleSendEvents(const bool& allValues, const Label_ID& l)
-    : storage((uint8_t*)malloc(bytes)), decodedLabels(NULL) {
-    assert(bytes > 0);
+PossibleSendEvents::PossibleSendEvents(const bool& allValues, const Label_ID& l) {
+    assert(words > 0);
     assert((allValues and l <= 1) or(not allValues and SENDING(l)));
 
-    if(not args_info.tg_given){
-    	// if allValues is set, initially all sending events are reachable
-    	memset(storage, (allValues ? 255 : 0), bytes);
+    if (not inline_storage) {
+        storage = static_cast<uint64_t*>(malloc(words * sizeof(uint64_t)));
+        assert(storage);
     }
-    else {
-    	memset(storage, 0, bytes);
+
+    // if allValues is set, initially all sending events are reachable
+    if (allValues and not args_info.tg_given) {
+        setTrue();
+    } else {
+        setFalse();
     }
 
     // set one particular label to 1
@@ -87,17 +95,23 @@ PossibleSendEvents::PossibleSendEvents(const bool& allValues, const Label_ID& l)
     }
 }
 
+PossibleSendEvents::PossibleSendEvents(const PossibleSendEvents& other) {
+    if (not inline_storage) {
+        storage = static_cast<uint64_t*>(malloc(words * sizeof(uint64_t)));
+        assert(storage);
+    }
+    memcpy(data(), other.data(), words * sizeof(uint64_t));
+}
+
+
 /**************
  * DESTRUCTOR *
  **************/
 
-/*!
- \note decodedLabels is deleted, but there might be still pointers pointing
-       at this memory; don't try to delete these pointers (double free)!
-*/
 PossibleSendEvents::~PossibleSendEvents() {
-    free(storage);
-    delete[] decodedLabels;
+    if (not inline_storage) {
+        free(storage);
+    }
 }
 
 
@@ -106,65 +120,64 @@ PossibleSendEvents::~PossibleSendEvents() {
  *************/
 
 void PossibleSendEvents::operator&=(const PossibleSendEvents& other) {
-    for (size_t i = 0; i < bytes; ++i) {
-        storage[i] &= other.storage[i];
-    }
+    *this &= other.data();
 }
 
 void PossibleSendEvents::operator|=(const PossibleSendEvents& other) {
-    for (size_t i = 0; i < bytes; ++i) {
-        storage[i] |= other.storage[i];
+    *this |= other.data();
+}
+
+/*!
+ \param other the sending events of an inner marking (see
+        InnerMarking::sendEvents())
+*/
+void PossibleSendEvents::operator&=(const uint64_t* other) {
+    uint64_t* a = data();
+    for (size_t i = 0; i < words; ++i) {
+        a[i] &= other[i];
     }
 }
 
-bool PossibleSendEvents::operator==(const PossibleSendEvents& other) {
-    for (size_t i = 0; i < bytes; ++i) {
-        if (storage[i] != other.storage[i]) {
-            return false;
-        }
+/*!
+ \param other the sending events of an inner marking (see
+        InnerMarking::sendEvents())
+*/
+void PossibleSendEvents::operator|=(const uint64_t* other) {
+    uint64_t* a = data();
+    for (size_t i = 0; i < words; ++i) {
+        a[i] |= other[i];
     }
-    return true;
 }
 
+bool PossibleSendEvents::operator==(const PossibleSendEvents& other) const {
+    return memcmp(data(), other.data(), words * sizeof(uint64_t)) == 0;
+}
+
+
 /******************
  * MEMBER METHODS *
  ******************/
 
 void PossibleSendEvents::labelPossible(const Label_ID& l) {
-    assert(storage != NULL);
     assert(SENDING(l));
 
-    const uint8_t myByte = (l - Label::first_send) / 8;
-    const uint8_t myBit  = (l - Label::first_send) % 8;
-    storage[myByte] += (1 << myBit);
+    const Label_ID e = l - Label::first_send;
+    data()[e / 64] |= static_cast<uint64_t>(1) << (e % 64);
 }
 
 /*!
- decode the bit array into a char array (function is called more than once)
+ reduction rule: smart sending event
+ set all bits to false (needed when analyzing an SCC of inner markings)
 */
-char* PossibleSendEvents::decode() {
-    assert(bytes > 0);
-
-    // only reserve memory and encode on first decoding
-    if (decodedLabels == NULL) {
-        decodedLabels = new char[Label::send_events];
-
-        // decode and store values
-        for (Label_ID l = 0; l < Label::send_events; ++l) {
-            const uint8_t myByte = l / 8;
-            const uint8_t myBit  = l % 8;
-            decodedLabels[l] = (storage[myByte] & (1 << myBit)) >> myBit;
-        }
-    }
-
-    return decodedLabels;
+void PossibleSendEvents::setFalse() {
+    memset(data(), 0, words * sizeof(uint64_t));
 }
 
 /*!
  reduction rule: smart sending event
- set all bits to false (needed when analyzing an SCC of inner markings)
+ set all bits to true (initially, every sending event is possible in a
+ knowledge)
 */
-void PossibleSendEvents::setFalse() {
-    memset(storage, 0, bytes);
+void PossibleSendEvents::setTrue() {
+    memset(data(), 255, words * sizeof(uint64_t));
 }
-
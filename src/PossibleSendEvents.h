@@ -20,18 +20,36 @@
 #pragma once
 
 #include "types.h"
+#include "InterfaceMarking.h"
+#include "Label.h"
 
 /*!
  \brief storage for sending events reachable by an inner marking
+
+ The sending events are stored as a bitset of 64 bit words, so they are
+ combined word by word and tested without decoding. If the words fit into
+ the object itself (see INLINE_WORDS), no further memory is allocated.
  */
 class PossibleSendEvents {
+        friend class InnerMarking;
+        friend class StateSpaceCache;
+
     public: /* static functions */
         /// initializes the class PossibleSendEvents
         static void initialize();
 
+        /// whether the given sending event is set in the given words
+        inline static bool possible(const uint64_t* events, const Label_ID& l) {
+            const Label_ID e = l - Label::first_send;
+            return (events[e / 64] >> (e % 64)) & 1;
+        }
+
     private: /* static attributes */
-        /// the number of bytes needed
-        static uint8_t bytes;
+        /// the number of 64 bit words needed
+        static uint8_t words;
+
+        /// whether the words are stored inline (i.e., words <= INLINE_WORDS)
+        static bool inline_storage;
 
     public: /* member functions */
         /// constructor
@@ -40,32 +58,61 @@ class PossibleSendEvents {
         /// constructor with initialization
         PossibleSendEvents(const bool&, const Label_ID&);
 
-        /// destructor; also cleans decodedLabels
+        /// copy constructor
+        PossibleSendEvents(const PossibleSendEvents&);
+
+        /// destructor
         ~PossibleSendEvents();
 
         /// set all sending events to false
         void setFalse();
 
+        /// set all sending events to true
+        void setTrue();
+
         /// overloaded bit-wise AND operator
         void operator&=(const PossibleSendEvents&);
 
         /// overloaded bit-wise OR operator
         void operator|=(const PossibleSendEvents&);
 
+        /// bit-wise AND with the sending events of an inner marking
+        void operator&=(const uint64_t*);
+
+        /// bit-wise OR with the sending events of an inner marking
+        void operator|=(const uint64_t*);
+
         /// overloaded comparison operator
-        bool operator==(const PossibleSendEvents&);
+        bool operator==(const PossibleSendEvents&) const;
 
-        /// returns array of all sending events (possible or not)
-        char* decode();
+        /// whether the given sending event is possible
+        inline bool possible(const Label_ID& l) const {
+            return possible(data(), l);
+        }
 
     private:
         /// set a label to be possible
         void labelPossible(const Label_ID&);
 
+        /// returns the words storing the sending events
+        inline uint64_t* data() {
+            return inline_storage ? local : storage;
+        }
+
+        /// returns the words storing the sending events
+        inline const uint64_t* data() const {
+            return inline_storage ? local : storage;
+        }
+
     private: /* member attributes */
-        /// a byte array to store the possible sending events
-        uint8_t* storage;
+        union {
+            /// a word array to store the possible sending events
+            uint64_t* storage;
+
+            /// the possible sending events if they fit into the object
+            uint64_t local[INLINE_WORDS];
+        };
 
-        /// array of all sending events (possible or not); built by decode()
-        char* decodedLabels;
+        /// no assignment (the words may be owned by the object)
+        PossibleSendEvents& operator=(const PossibleSendEvents&);
 };
@@ -27,20 +27,27 @@ size_t Queue::maximal_length = 0;
 size_t Queue::initial_length = 128;
 size_t Queue::current_objects = 0;
 size_t Queue::maximal_objects = 0;
+pthread_mutex_t Queue::mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 Queue::Queue()
-    : interface(static_cast<InterfaceMarking**>(malloc(initial_length* SIZEOF_VOIDP))),
-      inner(static_cast<InnerMarking_ID*>(malloc(initial_length* sizeof(InnerMarking_ID)))),
-      first(0), last(0) {
+    : interface(NULL), inner(NULL), first(0), last(0), length(0) {
+    pthread_mutex_lock(&mutex);
+    length = initial_length;
+    maximal_objects = (++current_objects > maximal_objects) ? current_objects : maximal_objects;
+    pthread_mutex_unlock(&mutex);
+
+    interface = static_cast<InterfaceMarking**>(malloc(length * SIZEOF_VOIDP));
+    inner = static_cast<InnerMarking_ID*>(malloc(length * sizeof(InnerMarking_ID)));
     assert(interface);
     assert(inner);
-    maximal_objects = (++current_objects > maximal_objects) ? current_objects : maximal_objects;
 }
 
 Queue::~Queue() {
+    pthread_mutex_lock(&mutex);
     maximal_length = (last > maximal_length) ? last : maximal_length;
     --current_objects;
+    pthread_mutex_unlock(&mutex);
 
     free(interface);
     free(inner);
@@ -48,13 +55,17 @@ Queue::~Queue() {
 
 void Queue::push(InnerMarking_ID _inner, InterfaceMarking* _interface) {
     // if storage is full
-    if (last++ == initial_length) {
+    if (last++ == length) {
         // double its size and use this size from now on
-        initial_length *= 2;
-        interface = static_cast<InterfaceMarking**>(realloc(interface, initial_length * SIZEOF_VOIDP));
-        inner = static_cast<InnerMarking_ID*>(realloc(inner, initial_length * sizeof(InnerMarking_ID)));
+        length *= 2;
+        interface = static_cast<InterfaceMarking**>(realloc(interface, length * SIZEOF_VOIDP));
+        inner = static_cast<InnerMarking_ID*>(realloc(inner, length * sizeof(InnerMarking_ID)));
         assert(interface);
         assert(inner);
+
+        pthread_mutex_lock(&mutex);
+        initial_length = (length > initial_length) ? length : initial_length;
+        pthread_mutex_unlock(&mutex);
     }
 
     inner[last - 1] = _inner;
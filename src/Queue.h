@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <pthread.h>
 #include "types.h"
 #include "InterfaceMarking.h"
 
@@ -37,6 +38,9 @@ class Queue {
         static size_t maximal_objects;
 
     private:
+        /// mutex to protect the static attributes (queues are used by several threads)
+        static pthread_mutex_t mutex;
+
         /// a vector to implement the interface marking queue
         InterfaceMarking** interface;
 
@@ -49,6 +53,9 @@ class Queue {
         /// index of the bottom element
         size_t last;
 
+        /// the reserved length of this queue
+        size_t length;
+
     public:
         /// constructor
         Queue();
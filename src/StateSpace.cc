@@ -0,0 +1,572 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include "StateSpace.h"
+#include "FinalCondition.h"
+#include "InnerMarking.h"
+#include "InternalReduction.h"
+#include "Label.h"
+#include "Cover.h"
+#include "Output.h"
+#include "cmdline.h"
+#include "util.h"
+#include "verbose.h"
+
+
+/// a file to store a mapping from marking ids to actual Petri net markings
+extern Output* markingoutput;
+
+/// the command line parameters
+extern gengetopt_args_info args_info;
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+std::vector<const pnapi::Place*> StateSpace::places;
+std::vector<StateSpace::Transition> StateSpace::transitions;
+std::vector<unsigned int> StateSpace::tokens;
+std::vector<hash_t> StateSpace::hashes;
+std::vector<InnerMarking_ID> StateSpace::table;
+std::vector<std::pair<size_t, InnerMarking_ID> > StateSpace::edges;
+StateSpace::_stats StateSpace::stats = {0, 0};
+
+
+/// marks an empty slot of the hash table
+#define EMPTY_SLOT static_cast<InnerMarking_ID>(-1)
+
+
+/****************************
+ * STATIC MEMBER FUNCTIONS *
+ ****************************/
+
+/*!
+ Collects the places and the transitions of the inner of the net. The places
+ are numbered like in class FinalCondition, so the final condition can be
+ evaluated on the stored token counts. The transitions are ordered by name,
+ so the search (and hence the numbering of the markings) does not depend on
+ the memory layout of the net. Finally, the persistent transitions are
+ determined (see class description).
+
+ \pre FinalCondition::initialize() has been called.
+*/
+void StateSpace::initialize() {
+    std::map<const pnapi::Place*, size_t> index;
+    for (size_t i = 0; i < FinalCondition::placeCount(); ++i) {
+        index[FinalCondition::place(i)] = places.size();
+        places.push_back(FinalCondition::place(i));
+    }
+
+    std::map<std::string, const pnapi::Transition*> byName;
+    FOREACH(t, InnerMarking::net->getTransitions()) {
+        byName[(*t)->getName()] = *t;
+    }
+
+    FOREACH(t, byName) {
+        Transition transition;
+        transition.name = t->first;
+
+        // internal transitions are not contained in the mapping
+        std::map<std::string, Label_ID>::const_iterator l = Label::name2id.find(t->first);
+        transition.label = (l != Label::name2id.end()) ? l->second : 0;
+
+        FOREACH(a, t->second->getPresetArcs()) {
+            transition.consume.push_back(std::make_pair(index[&(*a)->getPlace()], (*a)->getWeight()));
+        }
+        FOREACH(a, t->second->getPostsetArcs()) {
+            transition.produce.push_back(std::make_pair(index[&(*a)->getPlace()], (*a)->getWeight()));
+        }
+
+        transition.persistent = false;
+        transitions.push_back(transition);
+    }
+
+    if (args_info.partialOrderReduction_flag) {
+        // the number of transitions consuming from each place
+        std::vector<unsigned int> consumers(places.size(), 0);
+        FOREACH(t, transitions) {
+            FOREACH(a, t->consume) {
+                ++consumers[a->first];
+            }
+        }
+
+        FOREACH(t, transitions) {
+            if (t->label != 0 or t->consume.empty()) {
+                continue;
+            }
+
+            bool exclusive = true, mayBeFinal = true, mayLeadToFinal = true;
+            FOREACH(a, t->consume) {
+                exclusive = exclusive and (consumers[a->first] == 1);
+                mayBeFinal = mayBeFinal and not FinalCondition::excludes(a->first, a->second);
+            }
+            FOREACH(a, t->produce) {
+                mayLeadToFinal = mayLeadToFinal and not FinalCondition::excludes(a->first, a->second);
+            }
+
+            t->persistent = exclusive and not mayBeFinal and not mayLeadToFinal;
+        }
+    }
+
+    table.assign(1024, EMPTY_SLOT);
+}
+
+
+void StateSpace::finalize() {
+    std::vector<const pnapi::Place*>().swap(places);
+    std::vector<Transition>().swap(transitions);
+    std::vector<unsigned int>().swap(tokens);
+    std::vector<hash_t>().swap(hashes);
+    std::vector<InnerMarking_ID>().swap(table);
+    std::vector<std::pair<size_t, InnerMarking_ID> >().swap(edges);
+}
+
+
+bool StateSpace::enabled(const Transition& t, const unsigned int* marking) {
+    FOREACH(a, t.consume) {
+        if (marking[a->first] < a->second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*!
+ \param[in]  t        an enabled transition
+ \param[in]  current  the token counts of the marking
+ \param[out] marking  the token counts of the successor marking
+*/
+void StateSpace::fire(const Transition& t, const unsigned int* current, std::vector<unsigned int>& marking) {
+    std::copy(current, current + places.size(), marking.begin());
+    FOREACH(a, t.consume) {
+        marking[a->first] -= a->second;
+    }
+    FOREACH(a, t.produce) {
+        marking[a->first] += a->second;
+    }
+}
+
+
+bool StateSpace::dead(const InnerMarking_ID& id) {
+    const unsigned int* marking = &tokens[id * places.size()];
+    FOREACH(t, transitions) {
+        if (enabled(*t, marking)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*!
+ \param[in] id  the identifier of a stored marking
+
+ \return the first persistent transition enabled in the marking, or
+         transitions.size() if there is none and all enabled transitions
+         have to be fired
+*/
+size_t StateSpace::ample(const InnerMarking_ID& id) {
+    if (not args_info.partialOrderReduction_flag) {
+        return transitions.size();
+    }
+
+    const unsigned int* marking = &tokens[id * places.size()];
+    for (size_t t = 0; t < transitions.size(); ++t) {
+        if (transitions[t].persistent and enabled(transitions[t], marking)) {
+            return t;
+        }
+    }
+    return transitions.size();
+}
+
+
+/*!
+ Doubles the size of the hash table. The hash values of the stored markings
+ are kept, so the markings need not be hashed again.
+*/
+void StateSpace::grow() {
+    std::vector<InnerMarking_ID> newTable(table.size() * 2, EMPTY_SLOT);
+    const size_t mask = newTable.size() - 1;
+
+    FOREACH(id, table) {
+        if (*id != EMPTY_SLOT) {
+            size_t slot = hashes[*id] & mask;
+            while (newTable[slot] != EMPTY_SLOT) {
+                slot = (slot + 1) & mask;
+            }
+            newTable[slot] = *id;
+        }
+    }
+
+    table.swap(newTable);
+}
+
+
+/*!
+ \param[in]  marking  the token counts of a marking
+ \param[out] isNew    whether the marking has not been stored before
+
+ \return the identifier of the marking; new markings are numbered
+         consecutively in the order they are found
+
+ \note The hash value is calculated using 64 bit FNV-1a.
+*/
+InnerMarking_ID StateSpace::find(const std::vector<unsigned int>& marking, bool& isNew) {
+    const size_t size = places.size();
+
+    hash_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ marking[i]) * 1099511628211ULL;
+    }
+
+    const size_t mask = table.size() - 1;
+    size_t slot = hash & mask;
+    while (table[slot] != EMPTY_SLOT) {
+        const InnerMarking_ID id = table[slot];
+        if (hashes[id] == hash and std::equal(marking.begin(), marking.end(), tokens.begin() + id * size)) {
+            isNew = false;
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const InnerMarking_ID id = hashes.size();
+    table[slot] = id;
+    hashes.push_back(hash);
+    tokens.insert(tokens.end(), marking.begin(), marking.end());
+
+    // keep the load factor below 1/2
+    if (2 * hashes.size() > table.size()) {
+        grow();
+    }
+
+    isNew = true;
+    return id;
+}
+
+
+/*!
+ Creates the inner marking (or the node of the graph to be reduced) of a
+ marking the depth-first search has finished. This corresponds to parsing a
+ state from LoLA's output.
+
+ \param[in]     id       the identifier of the marking
+ \param[in]     lowlink  the Tarjan lowlink value of the marking
+ \param[in,out] stack    Tarjan's stack; the members of the SCC are removed
+                         if the marking is its representative
+ \param[in]     first    the position of the marking's first outgoing edge
+                         in the edge stack; the edges are removed
+*/
+void StateSpace::finish(const InnerMarking_ID& id, const InnerMarking_ID& lowlink,
+                        std::vector<InnerMarking_ID>& stack, const size_t& first) {
+    const size_t size = places.size();
+    const unsigned int* marking = &tokens[id * size];
+
+    const bool final = FinalCondition::satisfied(marking);
+
+    // collect the members of the SCC if this marking is its representative
+    std::set<InnerMarking_ID> scc;
+    if (lowlink == id) {
+        while (stack.back() != id) {
+            scc.insert(stack.back());
+            stack.pop_back();
+        }
+        stack.pop_back();
+    }
+
+    if (args_info.internalReduction_flag) {
+        // the graph is reduced before the inner markings are created
+        for (size_t i = 0; i < size; ++i) {
+            if (marking[i] > 0) {
+                Graph::g->addMarking(id, places[i]->getName().c_str(), marking[i]);
+            }
+        }
+        if (final) {
+            Graph::g->addFinal(id);
+        }
+        for (size_t e = first; e < edges.size(); ++e) {
+            Graph::g->addEdge(id, edges[e].second, transitions[edges[e].first].name.c_str());
+        }
+    } else {
+        std::vector<Label_ID> labels;
+        std::vector<InnerMarking_ID> successors;
+        std::set<std::string> enabled;
+
+        for (size_t e = first; e < edges.size(); ++e) {
+            const Transition& t = transitions[edges[e].first];
+
+            // a workaround for bug #14719
+            if (SYNC(t.label)) {
+                for (size_t i = 0; i < labels.size(); ++i) {
+                    if (labels[i] == t.label) {
+                        abort(17, "synchronous label '%s' of transition '%s' already used in this marking", Label::id2name[t.label].c_str(), t.name.c_str());
+                    }
+                }
+            }
+
+            labels.push_back(t.label);
+            successors.push_back(edges[e].second);
+            if (args_info.cover_given) {
+                enabled.insert(t.name);
+            }
+        }
+
+        InnerMarking::markingMap[id] = new InnerMarking(id, labels, successors, final);
+
+        // a PN API marking is only needed for the marking information and the cover
+        std::map<const pnapi::Place*, unsigned int> pnapiMarking;
+        if (markingoutput or args_info.cover_given) {
+            for (size_t i = 0; i < size; ++i) {
+                if (marking[i] > 0) {
+                    pnapiMarking[places[i]] = marking[i];
+                }
+            }
+        }
+
+        if (markingoutput) {
+            markingoutput->stream() << id << ": ";
+            FOREACH(p, pnapiMarking) {
+                if (p != pnapiMarking.begin()) {
+                    markingoutput->stream() << ", ";
+                }
+                markingoutput->stream() << p->first->getName() << ":" << p->second;
+            }
+            markingoutput->stream() << "\n";
+        }
+
+        if (args_info.cover_given) {
+            Cover::checkInnerMarking(id, pnapiMarking, enabled);
+        }
+
+        InnerMarking::evaluateSCC(id, lowlink, scc);
+    }
+
+    edges.resize(first);
+}
+
+
+/*!
+ Calculates the reachability graph of the inner of the net with an iterative
+ depth-first search. A marking is handed over to finish() as soon as all its
+ successors are explored. Hence, the markings are created in the same order
+ as the parser of LoLA's output creates them and all members of an SCC are
+ known when its representative is created.
+
+ With option --partialOrderReduction, a marking enabling a persistent
+ transition only fires this transition unless its successor is on the
+ search stack.
+
+ \pre The labels have been initialized.
+ \post InnerMarking::markingMap contains all reachable markings (or, in case
+       the internal reduction is used, Graph::g contains the reachability
+       graph).
+*/
+void StateSpace::calculate() {
+    initialize();
+
+    const size_t size = places.size();
+
+    std::vector<Frame> search;
+    std::vector<InnerMarking_ID> lowlink;
+    std::vector<bool> onStack;
+    std::vector<InnerMarking_ID> stack;
+    std::vector<unsigned int> marking(size);
+
+    // the initial marking
+    size_t i = 0;
+    FOREACH(p, places) {
+        marking[i++] = (*p)->getTokenCount();
+    }
+
+    bool isNew;
+    const InnerMarking_ID initial = find(marking, isNew);
+    lowlink.push_back(initial);
+    onStack.push_back(true);
+    stack.push_back(initial);
+    Frame f = { initial, 0, 0, ample(initial) };
+    search.push_back(f);
+
+    while (not search.empty()) {
+        Frame& top = search.back();
+
+        // all transitions have been tried: the marking is finished
+        if (top.transition == transitions.size()) {
+            const InnerMarking_ID id = top.id;
+            const size_t firstEdge = top.firstEdge;
+            if (top.ample != transitions.size()) {
+                ++stats.reduced_markings;
+            }
+            search.pop_back();
+
+            if (lowlink[id] == id) {
+                for (std::vector<InnerMarking_ID>::reverse_iterator s = stack.rbegin(); *s != id; ++s) {
+                    onStack[*s] = false;
+                }
+                onStack[id] = false;
+            }
+
+            finish(id, lowlink[id], stack, firstEdge);
+
+            if (not search.empty()) {
+                const InnerMarking_ID parent = search.back().id;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[id]);
+            }
+            continue;
+        }
+
+        // check whether the next transition is enabled
+        const bool reduced = (top.ample != transitions.size());
+        const size_t transition = reduced ? top.ample : top.transition++;
+        const Transition& t = transitions[transition];
+        const unsigned int* current = &tokens[top.id * size];
+
+        if (reduced) {
+            top.transition = transitions.size();
+        } else if (not enabled(t, current)) {
+            continue;
+        }
+
+        fire(t, current, marking);
+
+        const InnerMarking_ID source = top.id;
+        const InnerMarking_ID target = find(marking, isNew);
+
+        // a persistent transition closing a cycle could be postponed forever
+        if (reduced and not isNew and onStack[target]) {
+            top.ample = transitions.size();
+            top.transition = 0;
+            continue;
+        }
+
+        edges.push_back(std::make_pair(transition, target));
+
+        if (isNew) {
+            // descend
+            lowlink.push_back(target);
+            onStack.push_back(true);
+            stack.push_back(target);
+            Frame g = { target, 0, edges.size(), ample(target) };
+            search.push_back(g);
+        } else if (onStack[target]) {
+            lowlink[source] = std::min(lowlink[source], target);
+        }
+    }
+
+    if (args_info.partialOrderReduction_flag) {
+        status("partial order reduction: fired only a persistent transition in %d markings", stats.reduced_markings);
+    }
+
+    stats.stored_markings = hashes.size();
+    finalize();
+}
+
+
+/*!
+ Prepares expanding the markings on the fly: the places and transitions are
+ collected and the initial marking is stored with identifier 0. The memory
+ is kept until finalize() is called.
+
+ \pre The labels have been initialized.
+ \post InnerMarking expands the markings with expand() when it needs them.
+*/
+void StateSpace::start() {
+    initialize();
+
+    std::vector<unsigned int> marking(places.size());
+    size_t i = 0;
+    FOREACH(p, places) {
+        marking[i++] = (*p)->getTokenCount();
+    }
+
+    bool isNew;
+    find(marking, isNew);
+    stats.stored_markings = hashes.size();
+
+    InnerMarking::lazy = true;
+}
+
+
+/*!
+ Calculates the successors of a stored marking, stores the new ones, and
+ creates the inner marking. Successors that enable no transition are
+ created right away (they have no successors to calculate), so the inner
+ marking can detect whether it inevitably reaches a deadlock.
+
+ \param[in] id  the identifier of a stored marking that is not expanded yet
+
+ \pre start() has been called.
+*/
+void StateSpace::expand(const InnerMarking_ID& id) {
+    const size_t size = places.size();
+    assert(id < hashes.size());
+
+    std::vector<unsigned int> marking(size);
+    std::vector<Label_ID> labels;
+    std::vector<InnerMarking_ID> successors;
+
+    for (size_t transition = 0; transition < transitions.size(); ++transition) {
+        const Transition& t = transitions[transition];
+
+        // the stored markings are moved when a new marking is stored
+        const unsigned int* current = &tokens[id * size];
+        if (not enabled(t, current)) {
+            continue;
+        }
+
+        // a workaround for bug #14719
+        if (SYNC(t.label)) {
+            for (size_t i = 0; i < labels.size(); ++i) {
+                if (labels[i] == t.label) {
+                    abort(17, "synchronous label '%s' of transition '%s' already used in this marking", Label::id2name[t.label].c_str(), t.name.c_str());
+                }
+            }
+        }
+
+        fire(t, current, marking);
+
+        bool isNew;
+        labels.push_back(t.label);
+        successors.push_back(find(marking, isNew));
+    }
+
+    stats.stored_markings = hashes.size();
+    InnerMarking::lazyMarkings.resize(hashes.size(), NULL);
+
+    FOREACH(s, successors) {
+        if (InnerMarking::lazyMarkings[*s] == NULL and *s != id and dead(*s)) {
+            InnerMarking::lazyMarkings[*s] = new InnerMarking(*s, std::vector<Label_ID>(), std::vector<InnerMarking_ID>(),
+                                                              FinalCondition::satisfied(&tokens[*s * size]));
+        }
+    }
+
+    InnerMarking::lazyMarkings[id] = new InnerMarking(id, labels, successors, FinalCondition::satisfied(&tokens[id * size]));
+}
+
+
+void StateSpace::output_results(Results& r) {
+    r.add("statistics.inner_markings_reduced", stats.reduced_markings);
+    r.add("statistics.inner_markings_stored", stats.stored_markings);
+}
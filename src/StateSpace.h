@@ -0,0 +1,161 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <pnapi/pnapi.h>
+#include "Results.h"
+#include "types.h"
+
+
+/*!
+ \brief built-in generator of the reachability graph of the inner
+
+ The reachability graph of the inner of the net is explored depth first.
+ The markings are stored as vectors of token counts in a single array and
+ are found again using a hash table of marking identifiers. Tarjan's
+ algorithm runs along with the search, so each marking is handed over when
+ the search finishes it -- that is, in the same order, with the same kind of
+ identifiers (depth-first numbers), and with the same lowlink and SCC
+ information as LoLA prints them. Hence, the markings are processed exactly
+ like the markings parsed from LoLA's output.
+
+ With option --partialOrderReduction, a marking that enables a persistent
+ transition only fires this transition. A transition is persistent if it is
+ internal, no other transition consumes from its preset (so it commutes
+ with every other transition, including those of a partner), and neither a
+ marking enabling it nor a marking it produces can be final. Firing it
+ alone hence neither hides a visible event, a waitstate, or a final marking,
+ nor does it change which of them remain reachable. A marking whose only
+ successor closes a cycle on the search stack fires all its transitions,
+ so no transition is postponed forever.
+
+ With option --onTheFly, only the initial marking is stored in advance (see
+ start()). Every other marking is expanded when class InnerMarking first
+ needs it (see expand()); its successors are stored, but not expanded.
+
+ \note This class is a static helper class from which no objects are built.
+*/
+class StateSpace {
+    private: /* types */
+        /// a transition of the inner
+        struct Transition {
+            /// the name of the transition
+            std::string name;
+
+            /// the label of the transition (0 for internal transitions)
+            Label_ID label;
+
+            /// the places and weights of the preset
+            std::vector<std::pair<size_t, unsigned int> > consume;
+
+            /// the places and weights of the postset
+            std::vector<std::pair<size_t, unsigned int> > produce;
+
+            /// whether the transition may be fired alone (see class description)
+            bool persistent;
+        };
+
+        /// an entry of the depth-first search stack
+        struct Frame {
+            /// the marking
+            InnerMarking_ID id;
+
+            /// the next transition to be tried
+            size_t transition;
+
+            /// the position of the marking's first outgoing edge in the edge stack
+            size_t firstEdge;
+
+            /// the only transition to be fired (transitions.size() if all are fired)
+            size_t ample;
+        };
+
+    public: /* static functions */
+        /// calculate the reachability graph and create the inner markings
+        static void calculate();
+
+        /// store the initial marking to expand markings on the fly
+        static void start();
+
+        /// calculate the successors of a marking and create its inner marking
+        static void expand(const InnerMarking_ID&);
+
+        /// release the memory used during the calculation
+        static void finalize();
+
+        /// add information for results output
+        static void output_results(Results&);
+
+    private: /* static functions */
+        /// collect the places and transitions of the inner
+        static void initialize();
+
+        /// whether a transition is enabled in a marking
+        static bool enabled(const Transition&, const unsigned int*);
+
+        /// the marking reached by firing an enabled transition in a marking
+        static void fire(const Transition&, const unsigned int*, std::vector<unsigned int>&);
+
+        /// whether no transition is enabled in a stored marking
+        static bool dead(const InnerMarking_ID&);
+
+        /// returns the persistent transition to be fired alone in a marking
+        static size_t ample(const InnerMarking_ID&);
+
+        /// returns the identifier of a marking and stores the marking if it is new
+        static InnerMarking_ID find(const std::vector<unsigned int>&, bool&);
+
+        /// doubles the size of the hash table
+        static void grow();
+
+        /// hands over a marking once the depth-first search finished it
+        static void finish(const InnerMarking_ID&, const InnerMarking_ID&,
+                           std::vector<InnerMarking_ID>&, const size_t&);
+
+    private: /* static attributes */
+        static struct _stats {
+            /// the number of markings in which only a persistent transition was fired
+            unsigned int reduced_markings;
+
+            /// the number of stored markings (including those not expanded on the fly)
+            unsigned int stored_markings;
+        } stats;
+
+        /// the places of the inner
+        static std::vector<const pnapi::Place*> places;
+
+        /// the transitions of the inner (ordered by name)
+        static std::vector<Transition> transitions;
+
+        /// the token counts of all stored markings (places.size() entries per marking)
+        static std::vector<unsigned int> tokens;
+
+        /// the hash values of all stored markings
+        static std::vector<hash_t> hashes;
+
+        /// the hash table of marking identifiers
+        static std::vector<InnerMarking_ID> table;
+
+        /// the outgoing edges (transition and successor) of the markings on the search stack
+        static std::vector<std::pair<size_t, InnerMarking_ID> > edges;
+};
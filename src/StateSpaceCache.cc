@@ -0,0 +1,282 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#ifdef HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "StateSpaceCache.h"
+#include "InnerMarking.h"
+#include "PossibleSendEvents.h"
+#include "Label.h"
+#include "cmdline.h"
+#include "util.h"
+#include "verbose.h"
+
+
+/// the command line parameters
+extern gengetopt_args_info args_info;
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+hash_t StateSpaceCache::key = 0;
+std::string StateSpaceCache::filename;
+char* StateSpaceCache::file = NULL;
+size_t StateSpaceCache::fileSize = 0;
+
+
+/// the version of the file format; to be increased whenever it changes
+#define CACHE_VERSION 3
+
+/****************************
+ * STATIC MEMBER FUNCTIONS *
+ ****************************/
+
+/*!
+ The key of the cache file is the 64 bit FNV-1a hash value of a text that
+ consists of the parameters that influence the inner markings, the mapping
+ from transitions to labels, and the inner of the net in LoLA syntax. The
+ final condition is part of this text, because LoLA does not need it and it
+ is otherwise not written.
+*/
+void StateSpaceCache::initialize() {
+    std::stringstream ss;
+    ss << "correctness=" << args_info.correctness_arg
+       << " noDeadlockDetection=" << args_info.noDeadlockDetection_flag
+       << " ignoreUnreceivedMessages=" << args_info.ignoreUnreceivedMessages_flag
+       << " internalReduction=" << args_info.internalReduction_flag
+       << " partialOrderReduction=" << args_info.partialOrderReduction_flag
+       << " stateSpace=" << args_info.stateSpace_arg << "\n";
+
+    ss << static_cast<int>(Label::receive_events) << " "
+       << static_cast<int>(Label::send_events) << " "
+       << static_cast<int>(Label::sync_events) << "\n";
+    FOREACH(l, Label::name2id) {
+        ss << l->first << "=" << static_cast<int>(l->second) << "\n";
+    }
+
+    ss << pnapi::io::lola << pnapi::io::formula << *InnerMarking::net;
+
+    const std::string text = ss.str();
+    key = 14695981039346656037ULL;
+    for (size_t i = 0; i < text.size(); ++i) {
+        key = (key ^ static_cast<unsigned char>(text[i])) * 1099511628211ULL;
+    }
+
+    char name[40];
+    sprintf(name, "%s-%016llx.rg", PACKAGE_TARNAME, static_cast<unsigned long long>(key));
+    filename = std::string(args_info.cache_arg ? args_info.cache_arg : ".") + "/" + name;
+}
+
+
+/*!
+ \return the number of 64 bit words of a bitset with one bit per marking
+*/
+size_t StateSpaceCache::words(const Header& header) {
+    return header.markings / 64 + 1;
+}
+
+
+size_t StateSpaceCache::size(const Header& header) {
+    return sizeof(Header)
+           + 3 * words(header) * sizeof(uint64_t)
+           + header.markings * header.send_words * sizeof(uint64_t)
+           + (header.markings + 1) * sizeof(uint32_t)
+           + header.edges * (sizeof(InnerMarking_ID) + sizeof(Label_ID));
+}
+
+
+/*!
+ \return whether the inner markings were read from the cache file; if so,
+         the compressed sparse row layout of class InnerMarking is set up and
+         InnerMarking::initialize() does not copy any markings
+
+ \note If the cache file is missing or does not match the net (e.g., because
+       it was written by another version), it is ignored and overwritten
+       later by store().
+*/
+bool StateSpaceCache::load() {
+    if (not args_info.cache_given) {
+        return false;
+    }
+
+    initialize();
+
+    // read the whole file
+    char* data = NULL;
+    size_t length = 0;
+#ifdef HAVE_SYS_MMAN_H
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        status("no cache file '%s' found", _cfilename_(filename));
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 and info.st_size >= static_cast<off_t>(sizeof(Header))) {
+        length = info.st_size;
+        void* const mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        data = (mapping == MAP_FAILED) ? NULL : static_cast<char*>(mapping);
+    }
+    close(fd);
+#else
+    FILE* const f = fopen(filename.c_str(), "rb");
+    if (f == NULL) {
+        status("no cache file '%s' found", _cfilename_(filename));
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (length >= sizeof(Header)) {
+        data = new char[length];
+        if (fread(data, 1, length, f) != length) {
+            delete[] data;
+            data = NULL;
+        }
+    }
+    fclose(f);
+#endif
+
+    if (data == NULL) {
+        status("could not read cache file '%s'", _cfilename_(filename));
+        return false;
+    }
+
+    // check whether the file belongs to the net
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+    if (strcmp(header.magic, "WENDYRG") != 0 or header.version != CACHE_VERSION or
+            header.sizes[0] != sizeof(InnerMarking_ID) or header.sizes[1] != sizeof(Label_ID) or
+            header.key != key or header.send_words != PossibleSendEvents::words or
+            header.markings == 0 or length != size(header)) {
+        status("ignoring cache file '%s' of another net or version", _cfilename_(filename));
+#ifdef HAVE_SYS_MMAN_H
+        munmap(data, length);
+#else
+        delete[] data;
+#endif
+        return false;
+    }
+    file = data;
+    fileSize = length;
+
+    // the arrays of the markings point into the file (see store() for the
+    // order of the arrays)
+    InnerMarking::_graph& graph = InnerMarking::graph;
+    graph.is_final = reinterpret_cast<uint64_t*>(file + sizeof(Header));
+    graph.is_waitstate = graph.is_final + words(header);
+    graph.is_bad = graph.is_waitstate + words(header);
+    graph.sendEvents = graph.is_bad + words(header);
+    graph.offsets = reinterpret_cast<uint32_t*>(graph.sendEvents + header.markings * header.send_words);
+    graph.successors = reinterpret_cast<InnerMarking_ID*>(graph.offsets + header.markings + 1);
+    graph.labels = reinterpret_cast<Label_ID*>(graph.successors + header.edges);
+
+    InnerMarking::is_acyclic = header.is_acyclic;
+    InnerMarking::stats.markings = header.markings;
+    InnerMarking::stats.final_markings = header.stats[0];
+    InnerMarking::stats.bad_states = header.stats[1];
+    InnerMarking::stats.inevitable_deadlocks = header.stats[2];
+
+    status("read %d inner markings from cache file '%s'", header.markings, _cfilename_(filename));
+
+    return true;
+}
+
+
+/*!
+ The file is first written under a temporary name and then renamed, so
+ several instances of Wendy may use the same cache directory.
+
+ \pre InnerMarking::initialize() has been called.
+ \note A cache file that cannot be written only yields a warning.
+*/
+void StateSpaceCache::store() {
+    if (not args_info.cache_given or loaded()) {
+        return;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    strcpy(header.magic, "WENDYRG");
+    header.version = CACHE_VERSION;
+    header.sizes[0] = sizeof(InnerMarking_ID);
+    header.sizes[1] = sizeof(Label_ID);
+    header.key = key;
+    header.markings = InnerMarking::stats.markings;
+    header.send_words = PossibleSendEvents::words;
+    header.is_acyclic = InnerMarking::is_acyclic;
+    header.stats[0] = InnerMarking::stats.final_markings;
+    header.stats[1] = InnerMarking::stats.bad_states;
+    header.stats[2] = InnerMarking::stats.inevitable_deadlocks;
+
+    const InnerMarking::_graph& graph = InnerMarking::graph;
+    header.edges = graph.offsets[header.markings];
+
+    std::stringstream temp;
+    temp << filename << "." << getpid();
+
+    FILE* const f = fopen(temp.str().c_str(), "wb");
+    bool written = (f != NULL);
+    if (written) {
+        // 64 bit words first to keep all arrays aligned
+        written = fwrite(&header, sizeof(Header), 1, f) == 1;
+        written = written and fwrite(graph.is_final, sizeof(uint64_t), words(header), f) == words(header);
+        written = written and fwrite(graph.is_waitstate, sizeof(uint64_t), words(header), f) == words(header);
+        written = written and fwrite(graph.is_bad, sizeof(uint64_t), words(header), f) == words(header);
+        written = written and fwrite(graph.sendEvents, sizeof(uint64_t), header.markings * header.send_words, f) == header.markings * header.send_words;
+        written = written and fwrite(graph.offsets, sizeof(uint32_t), header.markings + 1, f) == header.markings + 1;
+        written = written and fwrite(graph.successors, sizeof(InnerMarking_ID), header.edges, f) == header.edges;
+        written = written and fwrite(graph.labels, sizeof(Label_ID), header.edges, f) == header.edges;
+        written = (fclose(f) == 0) and written;
+    }
+
+    if (written and rename(temp.str().c_str(), filename.c_str()) == 0) {
+        status("wrote %d inner markings to cache file '%s'", header.markings, _cfilename_(filename));
+    } else {
+        remove(temp.str().c_str());
+        message("%s: %s", _cimportant_("warning"), _cwarning_("could not write cache file"));
+    }
+}
+
+
+void StateSpaceCache::finalize() {
+    if (file != NULL) {
+#ifdef HAVE_SYS_MMAN_H
+        munmap(file, fileSize);
+#else
+        delete[] file;
+#endif
+        file = NULL;
+    }
+}
+
+
+bool StateSpaceCache::loaded() {
+    return file != NULL;
+}
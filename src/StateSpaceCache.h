@@ -0,0 +1,112 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include "types.h"
+
+
+/*!
+ \brief binary cache of the inner markings
+
+ The inner markings (the arrays of their compressed sparse row layout, see
+ class InnerMarking) are written to a binary file once they are organized.
+ The name of the file is a hash of the inner of the net (in LoLA syntax,
+ including the final condition), of the interface labels, and of the
+ parameters that influence the inner markings. If such a file is present, it
+ is mapped into memory and the arrays of the inner markings point directly
+ into the mapped file instead of calculating the reachability graph.
+
+ The file consists of a header followed by the arrays in the order of
+ decreasing alignment: the bitsets of the final markings, waitstates, and
+ bad markings, the possible sending events, the offsets, the successors, and
+ the labels. Numbers are stored in the byte order of the machine, so a cache
+ file is only valid on the machine that wrote it.
+
+ \note This class is a static helper class from which no objects are built.
+*/
+class StateSpaceCache {
+    private: /* types */
+        /// the header of a cache file
+        struct Header {
+            /// the file type ("WENDYRG" and a null byte)
+            char magic[8];
+
+            /// the version of the file format
+            uint32_t version;
+
+            /// the size of a marking identifier and of a label
+            uint16_t sizes[2];
+
+            /// the hash value the file is named after
+            hash_t key;
+
+            /// the number of markings
+            uint32_t markings;
+
+            /// the number of edges
+            uint32_t edges;
+
+            /// the number of 64 bit words of the possible sending events of a marking
+            uint32_t send_words;
+
+            /// whether the reachability graph is acyclic
+            uint32_t is_acyclic;
+
+            /// the statistics of the inner markings
+            uint32_t stats[4];
+        };
+
+    public: /* static functions */
+        /// creates the inner markings from the cache file if it is present
+        static bool load();
+
+        /// writes the inner markings to the cache file unless they were loaded
+        static void store();
+
+        /// unmaps the cache file
+        static void finalize();
+
+        /// whether the inner markings were loaded from the cache file
+        static bool loaded();
+
+    private: /* static functions */
+        /// determines the name of the cache file
+        static void initialize();
+
+        /// the number of words of a bitset of the given header
+        static size_t words(const Header&);
+
+        /// the size of a cache file with the given header
+        static size_t size(const Header&);
+
+    private: /* static attributes */
+        /// the hash value of the net and the parameters
+        static hash_t key;
+
+        /// the name of the cache file
+        static std::string filename;
+
+        /// the mapped cache file (NULL if the markings were not read)
+        static char* file;
+
+        /// the size of the mapped cache file
+        static size_t fileSize;
+};
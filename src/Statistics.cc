@@ -0,0 +1,165 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+
+#include <config.h>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <sys/time.h>
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#include "Results.h"
+#include "Statistics.h"
+#include "verbose.h"
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+std::vector<std::string> Statistics::phases;
+std::vector<double> Statistics::durations;
+size_t Statistics::currentPhase = 0;
+double Statistics::phaseStart = 0;
+unsigned int Statistics::counters[COUNTERS] = { 0 };
+const char* Statistics::counterNames[COUNTERS] = {
+    "objects_knowledge", "objects_stored_knowledge",
+    "objects_interface_marking", "objects_composite_marking"
+};
+double Statistics::programStart = Statistics::now();
+
+
+/******************
+ * STATIC METHODS *
+ ******************/
+
+/*!
+ \note The monotonic clock is not affected by changes of the system time.
+       Systems without clock_gettime() fall back to gettimeofday().
+*/
+double Statistics::now() {
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec monotonic;
+    if (clock_gettime(CLOCK_MONOTONIC, &monotonic) == 0) {
+        return static_cast<double>(monotonic.tv_sec) + static_cast<double>(monotonic.tv_nsec) / 1e9;
+    }
+#endif
+    struct timeval current;
+    gettimeofday(&current, NULL);
+    return static_cast<double>(current.tv_sec) + static_cast<double>(current.tv_usec) / 1e6;
+}
+
+
+double Statistics::seconds() {
+    return now() - programStart;
+}
+
+
+/*!
+ \param[in] phase  the name of the phase as used in the results file
+*/
+void Statistics::startPhase(const std::string& phase) {
+    for (currentPhase = 0; currentPhase < phases.size(); ++currentPhase) {
+        if (phases[currentPhase] == phase) {
+            break;
+        }
+    }
+    if (currentPhase == phases.size()) {
+        phases.push_back(phase);
+        durations.push_back(0);
+    }
+
+    phaseStart = seconds();
+}
+
+
+double Statistics::stopPhase() {
+    assert(currentPhase < phases.size());
+
+    const double duration = seconds() - phaseStart;
+    durations[currentPhase] += duration;
+    return duration;
+}
+
+
+/*!
+ \note This function is called for every created interface marking, so it
+       must not serialize the threads that build knowledges.
+*/
+void Statistics::created(const Counter counter) {
+    __sync_fetch_and_add(&counters[counter], 1);
+}
+
+
+/*!
+ \note getrusage() reports the peak resident set size in KB on Linux, but in
+       bytes on Mac OS. Without getrusage(), the high water mark is read from
+       /proc/self/status (Linux only).
+*/
+unsigned int Statistics::peakMemory() {
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0 and usage.ru_maxrss > 0) {
+#if defined(__APPLE__)
+        return static_cast<unsigned int>(usage.ru_maxrss / 1024);
+#else
+        return static_cast<unsigned int>(usage.ru_maxrss);
+#endif
+    }
+#endif
+
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            std::istringstream value(line.substr(6));
+            unsigned int result = 0;
+            value >> result;
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+
+void Statistics::print() {
+    message("runtime: %s%.2f sec%s", _bold_, seconds(), _c_);
+    for (size_t i = 0; i < phases.size(); ++i) {
+        message("  %-22s %8.3f sec", phases[i].c_str(), durations[i]);
+    }
+    message("memory consumption: %s%u KB %s", _bold_, peakMemory(), _c_);
+}
+
+
+void Statistics::output_results(Results& r) {
+    r.add("timing.total", static_cast<float>(seconds()));
+    for (size_t i = 0; i < phases.size(); ++i) {
+        r.add("timing." + phases[i], static_cast<float>(durations[i]));
+    }
+
+    r.add("memory.peak_rss", peakMemory());
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        r.add(std::string("memory.") + counterNames[i], counters[i]);
+    }
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Results;
+
+
+/*!
+ \brief instrumentation (timers, memory, and object counters)
+
+ The phases of main() are measured with a monotonic clock. A phase is
+ started with startPhase() and ends with stopPhase(); phases are not nested.
+ If a phase is measured several times, the durations are summed up.
+
+ The constructors of the major classes count their objects with created().
+ As knowledges are built by several threads, the counters are incremented
+ atomically.
+
+ The results are printed with "--stats" and written to the results file
+ (sections "timing" and "memory").
+*/
+class Statistics {
+    public: /* types */
+        /// the classes whose objects are counted
+        enum Counter {
+            KNOWLEDGE,
+            STORED_KNOWLEDGE,
+            INTERFACE_MARKING,
+            COMPOSITE_MARKING,
+            COUNTERS
+        };
+
+    public: /* static functions */
+        /// returns the seconds since the start of the program (monotonic clock)
+        static double seconds();
+
+        /// returns the current time of the monotonic clock in seconds
+        static double now();
+
+        /// starts measuring a phase
+        static void startPhase(const std::string&);
+
+        /// stops measuring the current phase and returns its duration in seconds
+        static double stopPhase();
+
+        /// counts a created object of a class
+        static void created(const Counter);
+
+        /// returns the peak resident set size in KB (0 if unknown)
+        static unsigned int peakMemory();
+
+        /// print the statistics (option "--stats")
+        static void print();
+
+        /// print results
+        static void output_results(Results&);
+
+    private: /* static attributes */
+        /// the names of the measured phases (in the order of their first start)
+        static std::vector<std::string> phases;
+
+        /// the summed durations of the measured phases
+        static std::vector<double> durations;
+
+        /// the current phase (an index of phases) and when it was started
+        static size_t currentPhase;
+        static double phaseStart;
+
+        /// the number of created objects per class
+        static unsigned int counters[COUNTERS];
+
+        /// the names of the counters in the results file
+        static const char* counterNames[COUNTERS];
+
+        /// the start of the program (not relative to itself)
+        static double programStart;
+};
@@ -25,6 +25,10 @@
 #include <vector>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <pthread.h>
 
 #include "StoredKnowledge.h"
 #include "Cover.h"
@@ -32,9 +36,12 @@
 #include "cmdline.h"
 #include "LivelockOperatingGuideline.h"
 #include "AnnotationLivelockOG.h"
+#include "Statistics.h"
 #include "util.h"
 
+using std::deque;
 using std::map;
+using std::pair;
 using std::set;
 using std::string;
 using std::vector;
@@ -47,7 +54,7 @@ extern string invocation;
  * STATIC MEMBERS *
  ******************/
 
-std::map<hash_t, std::vector<StoredKnowledge*> > StoredKnowledge::hashTree;
+KnowledgeTable StoredKnowledge::knowledgeTable;
 StoredKnowledge* StoredKnowledge::root = NULL;
 StoredKnowledge* StoredKnowledge::empty = reinterpret_cast<StoredKnowledge*>(1);
 std::set<StoredKnowledge*> StoredKnowledge::deletedNodes;
@@ -56,30 +63,30 @@ std::vector<StoredKnowledge*> StoredKnowledge::tarjanStack;
 unsigned int StoredKnowledge::bookmarkTSCC = 0;
 bool StoredKnowledge::emptyNodeReachable = false;
 StoredKnowledge::_stats StoredKnowledge::stats;
-std::map<const StoredKnowledge*, std::pair<unsigned int, unsigned int> > StoredKnowledge::tarjanMapping;
 
 
 /********************
  * STATIC FUNCTIONS *
  ********************/
 
-/*!
- \note maxBucketSize must be initialized to 1
- */
 StoredKnowledge::_stats::_stats()
-    : hashCollisions(0), storedEdges(0), builtInsaneNodes(0),
-      maxBucketSize(1), storedKnowledges(0), maxSCCSize(0),
-      numberOfNonTrivialSCCs(0), numberOfTrivialSCCs(0) {}
+    : storedEdges(0), builtInsaneNodes(0), storedKnowledges(0), maxSCCSize(0),
+      numberOfNonTrivialSCCs(0), numberOfTrivialSCCs(0), skippedSuccessors(0) {}
 
 
 /*!
  \param[in] K   a knowledge bubble (explicitly stored)
  \param[in] SK  a knowledge bubble (compactly stored)
  \param[in] l   a label
+
+ \return the successor of K for label l if it is new and sane -- then its
+         successors still need to be calculated, and the caller has to
+         adjust the lowlink value of SK and delete it afterwards; NULL
+         otherwise
  */
-void StoredKnowledge::processSuccessor(const Knowledge* K,
-                                       StoredKnowledge* const SK,
-                                       const Label_ID& l) {
+Knowledge* StoredKnowledge::processSuccessor(const Knowledge* K,
+                                             StoredKnowledge* const SK,
+                                             const Label_ID& l) {
 
     // create a new knowledge for the given label
     Knowledge* K_new = new Knowledge(K, l);
@@ -88,9 +95,12 @@ void StoredKnowledge::processSuccessor(const Knowledge* K,
     if (K_new->size == 0) {
         if (K_new->is_sane) {
             SK->addSuccessor(l, empty);
+        } else {
+            // the node was not sane -- count it
+            ++stats.builtInsaneNodes;
         }
         delete K_new;
-        return;
+        return NULL;
     }
 
     // only process knowledges within the message bounds
@@ -108,7 +118,7 @@ void StoredKnowledge::processSuccessor(const Knowledge* K,
         if (SK_store == SK_new) {
             if (K_new->is_sane) {
                 // the node was new and sane, so check its successors
-                processNode(K_new, SK_store);
+                return K_new;
             }
 
         } else {
@@ -116,7 +126,7 @@ void StoredKnowledge::processSuccessor(const Knowledge* K,
             delete SK_new;
         }
 
-        // the successors of the new knowledge have been calculated, so adjust lowlink value of SK
+        // there are no successors to calculate, so adjust lowlink value of SK
         SK->adjustLowlinkValue(SK_store, SK_store == SK_new);
 
     } else {
@@ -125,60 +135,218 @@ void StoredKnowledge::processSuccessor(const Knowledge* K,
     }
 
     delete K_new;
+    return NULL;
 }
 
 
 /*!
+ \param[in] K  a knowledge bubble (explicitly stored)
+ \param[in] l  a label
+
+ \return whether the successor of K for label l is to be calculated; that is,
+         whether no reduction rule that only depends on K excludes l
+
+ \note As receiving labels precede sending and synchronous labels, the rule
+       "receive before send" excludes all labels after the receiving ones.
+ */
+bool StoredKnowledge::considerLabel(const Knowledge* const K, const Label_ID& l) {
+    // reduction rule: send leads to insane node
+    if (not args_info.ignoreUnreceivedMessages_flag and SENDING(l) and not K->considerSendingEvent(l)) {
+        return false;
+    }
+
+    // reduction rule: sequentialize receiving events
+    // if current receiving event is not to be considered, continue
+    if (args_info.seqReceivingEvents_flag and RECEIVING(l) and not K->considerReceivingEvent(l)) {
+        return false;
+    }
+
+    // reduction rule: receive before send
+    if (args_info.receivingBeforeSending_flag and not RECEIVING(l) and K->receivingHelps()) {
+        return false;
+    }
+
+    // reduction rule: only consider waitstates
+    if (args_info.waitstatesOnly_flag and not RECEIVING(l) and not K->resolvableWaitstate(l)) {
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ \brief a knowledge whose successors are calculated by processNode
+*/
+struct SearchFrame {
+    /// constructor
+    SearchFrame(Knowledge* const K, StoredKnowledge* const SK)
+        : K(K), SK(SK), l(Label::first_receive), K_succ(NULL) {}
+
+    /// the knowledge (explicitly stored)
+    Knowledge* K;
+
+    /// the knowledge (compactly stored)
+    StoredKnowledge* SK;
+
+    /// the label of the successor that is calculated
+    Label_ID l;
+
+    /// the successor for label l whose successors are calculated (or NULL)
+    Knowledge* K_succ;
+};
+
+
+/*!
+ Calculates the knowledges reachable from K depth first. Instead of
+ recursing into new and sane successors, the knowledges whose successors are
+ being calculated are kept on an explicit stack, so the depth of the
+ knowledge graph is not limited by the size of the process stack.
+
  \param[in] K   a knowledge bubble (explicitly stored)
  \param[in] SK  a knowledge bubble (compactly stored)
 
+ \note K is not deleted.
  \note possible optimization: don't create a copy for the last label but use
        the object itself
  */
 void StoredKnowledge::processNode(Knowledge* const K, StoredKnowledge* const SK) {
-    // traverse the labels of the interface and process K's successors
+    vector<SearchFrame> search(1, SearchFrame(K, SK));
 
-    for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
+    while (not search.empty()) {
+        SearchFrame& f = search.back();
 
-        // reduction rule: send leads to insane node
-        if (not args_info.ignoreUnreceivedMessages_flag and SENDING(l) and not K->considerSendingEvent(l)) {
-            continue;
+        // the successors of the successor have been calculated
+        if (f.K_succ) {
+            // adjust lowlink value of SK
+            f.SK->adjustLowlinkValue(f.SK->successor(f.l), true);
+            delete f.K_succ;
+            f.K_succ = NULL;
+
+            if (not considerNextLabel(f.K, f.SK, f.l)) {
+                finishNode(f.K, f.SK);
+                search.pop_back();
+                continue;
+            }
+            ++f.l;
         }
 
-        // reduction rule: sequentialize receiving events
-        // if current receiving event is not to be considered, continue
-        if (args_info.seqReceivingEvents_flag and RECEIVING(l) and not K->considerReceivingEvent(l)) {
+        // a new knowledge may be decided before calculating any successor
+        if (f.l == Label::first_receive and args_info.decideOnly_flag and decided(f.K, f.SK, 0)) {
+            finishNode(f.K, f.SK);
+            search.pop_back();
             continue;
         }
 
-        // reduction rule: receive before send
-        if (args_info.receivingBeforeSending_flag and not RECEIVING(l) and K->receivingHelps()) {
-            break;
+        // traverse the labels of the interface and process K's successors
+        bool finished = true;
+        for (; f.l <= Label::last_sync; ++f.l) {
+
+            // reduction rules
+            if (not considerLabel(f.K, f.l)) {
+                continue;
+            }
+
+            // descend into a new and sane successor
+            f.K_succ = processSuccessor(f.K, f.SK, f.l);
+            if (f.K_succ) {
+                finished = false;
+                break;
+            }
+
+            if (not considerNextLabel(f.K, f.SK, f.l)) {
+                break;
+            }
         }
 
-        // reduction rule: only consider waitstates
-        if (args_info.waitstatesOnly_flag and not RECEIVING(l) and not K->resolvableWaitstate(l)) {
-            continue;
+        if (finished) {
+            finishNode(f.K, f.SK);
+            search.pop_back();
+        } else {
+            // f is invalidated by push_back
+            search.push_back(SearchFrame(f.K_succ, f.SK->successor(f.l)));
         }
+    }
+}
 
-        // recursion
-        processSuccessor(K, SK, l);
 
-        // reduction rule: quit, once all waitstates are resolved
-        if (args_info.quitAsSoonAsPossible_flag and SK->sat(true)) {
-            break;
+/*!
+ \param[in]     K   a knowledge bubble (explicitly stored)
+ \param[in]     SK  a knowledge bubble (compactly stored)
+ \param[in,out] l   the label whose successor of SK has been processed; it
+                    is advanced if the labels up to a later one are to be
+                    skipped
+
+ \return whether the successors of SK for labels after l are to be
+         calculated
+ */
+bool StoredKnowledge::considerNextLabel(const Knowledge* const K, StoredKnowledge* const SK, Label_ID& l) {
+    // reduction rule: quit, once all waitstates are resolved
+    if (args_info.quitAsSoonAsPossible_flag and SK->sat(true)) {
+        return false;
+    }
+
+    // only deciding controllability: quit, once the sanity of SK is decided
+    if (args_info.decideOnly_flag and decided(K, SK, l)) {
+        return false;
+    }
+
+    // reduction rule: stop considering another sending event, if the
+    // latest sending event considered succeeded
+    /// \todo what about synchronous events?
+    if (args_info.succeedingSendingEvent_flag and SENDING(l) and SK->sat(true)) {
+        if ((args_info.correctness_arg != correctness_arg_livelock) or SK->is_final_reachable) {
+            l = Label::first_sync;
         }
+    }
 
-        // reduction rule: stop considering another sending event, if the
-        // latest sending event considered succeeded
-        /// \todo what about synchronous events?
-        if (args_info.succeedingSendingEvent_flag and SENDING(l) and SK->sat(true)) {
-            if ((args_info.correctness_arg != correctness_arg_livelock) or SK->is_final_reachable) {
-                l = Label::first_sync;
-            }
+    return true;
+}
+
+
+/*!
+ A knowledge is decided if it is satisfied by successors whose sanity is
+ already known (as in "quit as soon as possible"), or if it cannot be
+ satisfied even if all successors still to calculate were sane. In both
+ cases, its remaining successors do not influence its sanity and hence not
+ the controllability of the net.
+
+ \param[in] K     a knowledge bubble (explicitly stored)
+ \param[in] SK    a knowledge bubble (compactly stored)
+ \param[in] last  the label whose successor of SK has been processed last
+                  (0 if no successor has been processed yet)
+
+ \return whether the successors of SK for labels after last can be skipped;
+         these successors are then counted as skipped
+
+ \note Only the successor for label last can have made SK unsatisfiable, so
+       SK is only checked to be unsatisfiable if this successor is not sane.
+ */
+bool StoredKnowledge::decided(const Knowledge* const K, StoredKnowledge* const SK, const Label_ID& last) {
+    const StoredKnowledge* const SK_last = (last == 0) ? NULL : SK->successor(last);
+    const bool lastSane = (SK_last != NULL and SK_last != empty and SK_last->is_sane);
+
+    if (not SK->sat(true) and (lastSane or not SK->unsatisfiable(K, last))) {
+        return false;
+    }
+
+    for (Label_ID l = last + 1; l <= Label::last_sync; ++l) {
+        if (considerLabel(K, l)) {
+            ++stats.skippedSuccessors;
         }
     }
 
+    return true;
+}
+
+
+/*!
+ Evaluates a knowledge after all its successors have been calculated.
+
+ \param[in] K   a knowledge bubble (explicitly stored)
+ \param[in] SK  a knowledge bubble (compactly stored)
+ */
+void StoredKnowledge::finishNode(Knowledge* const K, StoredKnowledge* const SK) {
     SK->evaluateKnowledge();
 
     //for test guidelines: delete edges labeled with a sending message not weak receivable by the service
@@ -203,14 +371,14 @@ void StoredKnowledge::processNode(Knowledge* const K, StoredKnowledge* const SK)
     	bool hasSuccessors = false;
 
     	for (Label_ID l = Label::first_receive; l < Label::last_send + 1; ++l) {
-    		if (SK->successors[l - 1] != NULL and SK->successors[l - 1] != empty and SK->successors[l - 1]->is_sane){
-    			assert(SK->successors[l - 1]->s_minMessages);
+    		if (SK->successor(l) != NULL and SK->successor(l) != empty and SK->successor(l)->is_sane){
+    			assert(SK->successor(l)->s_minMessages);
 
     			hasSuccessors = true;
     			for (Label_ID label = Label::first_send; label <  Label::last_send + 1; ++label) {
     				current_pos = label - Label::first_send;
-    				if (SK->s_minMessages[current_pos] < SK->successors[l - 1]->s_minMessages[current_pos]){
-    					SK->s_minMessages[current_pos] = SK->successors[l - 1]->s_minMessages[current_pos];
+    				if (SK->s_minMessages[current_pos] < SK->successor(l)->s_minMessages[current_pos]){
+    					SK->s_minMessages[current_pos] = SK->successor(l)->s_minMessages[current_pos];
     				}
     			}
     		}
@@ -236,15 +404,334 @@ void StoredKnowledge::processNode(Knowledge* const K, StoredKnowledge* const SK)
     	//delete the edges labeled with a sending message not weak receivable at this point
     	for (Label_ID l = Label::first_send; l < Label::last_send + 1; ++l) {
     		current_pos = l - Label::first_send;
-    		if (SK->successors[l - 1] != NULL and SK->successors[l - 1]->is_sane and SK->successors[l-1]->s_minMessages[current_pos] > 0){
+    		if (SK->successor(l) != NULL and SK->successor(l)->is_sane and SK->successor(l)->s_minMessages[current_pos] > 0){
     			//the message is not weak receivable
-    			SK->successors[l-1] = NULL;
+    			SK->removeSuccessor(l);
     		}
     	}
     }
 }
 
 
+/*!
+ \brief a batch of successor knowledges to be calculated by several threads
+
+ Each task of a batch consists of a parent knowledge and a label. The threads
+ fetch the tasks in ascending order and store the successor of the task's
+ parent for the task's label at the task's index.
+
+ The threads are started once and then calculate one batch after the other:
+ the main thread publishes a batch by incrementing the generation and waits
+ until no thread is working on it any more.
+*/
+struct SuccessorBatch {
+    /// the parent knowledges of the tasks
+    vector<const Knowledge*> parents;
+
+    /// the labels of the tasks
+    vector<Label_ID> labels;
+
+    /// the calculated successors of the tasks
+    vector<Knowledge*> successors;
+
+    /// the index of the next task to fetch (incremented atomically)
+    size_t next;
+
+    /// the number of the current batch
+    unsigned int generation;
+
+    /// the number of threads still working on the current batch
+    unsigned int working;
+
+    /// whether all batches have been calculated
+    bool finished;
+
+    /// mutex to protect generation, working, and finished
+    pthread_mutex_t mutex;
+
+    /// signaled when a batch is published or all batches are finished
+    pthread_cond_t published;
+
+    /// signaled when the last thread stops working on a batch
+    pthread_cond_t calculated;
+};
+
+
+/*!
+ \param[in] batch  the batches (pointer to a SuccessorBatch object)
+
+ \return NULL -- the successors are stored in the batch
+ */
+void* StoredKnowledge::calculateSuccessors(void* batch) {
+    SuccessorBatch* const B = static_cast<SuccessorBatch*>(batch);
+    unsigned int generation = 0;
+
+    while (true) {
+        // wait for the next batch
+        pthread_mutex_lock(&B->mutex);
+        while (not B->finished and B->generation == generation) {
+            pthread_cond_wait(&B->published, &B->mutex);
+        }
+        if (B->finished) {
+            pthread_mutex_unlock(&B->mutex);
+            return NULL;
+        }
+        generation = B->generation;
+        pthread_mutex_unlock(&B->mutex);
+
+        calculateTasks(B);
+
+        // the last thread wakes up the main thread
+        pthread_mutex_lock(&B->mutex);
+        if (--B->working == 0) {
+            pthread_cond_signal(&B->calculated);
+        }
+        pthread_mutex_unlock(&B->mutex);
+    }
+}
+
+
+/*!
+ \param[in] batch  the current batch (pointer to a SuccessorBatch object)
+ */
+void StoredKnowledge::calculateTasks(void* batch) {
+    SuccessorBatch* const B = static_cast<SuccessorBatch*>(batch);
+
+    while (true) {
+        // fetch the next task
+        const size_t task = __sync_fetch_and_add(&B->next, 1);
+        if (task >= B->labels.size()) {
+            return;
+        }
+
+        B->successors[task] = new Knowledge(B->parents[task], B->labels[task]);
+    }
+}
+
+
+/*!
+ Calculates the same knowledges as processNode, but in two phases. First, the
+ knowledges are explored breadth first: the successors of a batch of
+ knowledges are calculated by a pool of threads (see SuccessorBatch) and then
+ stored by the main thread in a fixed order. Second, the stored knowledges are traversed depth
+ first in the order in which processNode would have calculated them to detect
+ and evaluate the SCCs. Hence, the result does not depend on the number of
+ threads.
+
+ The frontier of the breadth first search only holds stored knowledges. The
+ knowledges of a batch's parents are rebuilt from them (see
+ Knowledge::fromStored()) and deleted after the batch,
+ so the memory for explicit knowledges does not grow with the width of the
+ knowledge graph.
+
+ \param[in] K   a knowledge bubble (explicitly stored)
+ \param[in] SK  a knowledge bubble (compactly stored)
+
+ \pre SK is stored and sane.
+ \pre The reduction rules "quit as soon as possible" and "succeeding sending
+      event" as well as test guidelines are not used, because they depend on
+      the evaluation of knowledges during their calculation.
+
+ \note K is not deleted.
+ */
+void StoredKnowledge::processNodeParallel(Knowledge* const K, StoredKnowledge* const SK) {
+    assert(args_info.threads_arg > 1);
+    assert(not args_info.quitAsSoonAsPossible_flag);
+    assert(not args_info.succeedingSendingEvent_flag);
+    assert(not args_info.tg_given);
+
+    // the maximal number of knowledges whose successors form one batch
+    const size_t batchSize = 64 * args_info.threads_arg;
+
+    // the threads besides the main thread (started once for all batches)
+    vector<pthread_t> threads(args_info.threads_arg - 1);
+    SuccessorBatch batch;
+    batch.next = 0;
+    batch.generation = 0;
+    batch.working = 0;
+    batch.finished = false;
+    pthread_mutex_init(&batch.mutex, NULL);
+    pthread_cond_init(&batch.published, NULL);
+    pthread_cond_init(&batch.calculated, NULL);
+    for (size_t t = 0; t < threads.size(); ++t) {
+        if (pthread_create(&threads[t], NULL, calculateSuccessors, &batch) != 0) {
+            abort(18, "could not create thread");
+        }
+    }
+
+    // new and sane knowledges whose successors still need to be calculated;
+    // only their compact versions are kept, because the frontier of the
+    // breadth first search can be much wider than a path of processNode
+    deque<StoredKnowledge*> todo(1, SK);
+
+    while (not todo.empty()) {
+        const size_t parents = (todo.size() < batchSize) ? todo.size() : batchSize;
+
+        // rebuild the parents of the batch and collect its tasks (no thread
+        // is working on the batch now)
+        batch.parents.clear();
+        batch.labels.clear();
+        vector<Knowledge*> rebuiltParents;
+        vector<StoredKnowledge*> storedParents;
+        for (size_t i = 0; i < parents; ++i) {
+            Knowledge* const K_parent = (todo[i] == SK) ? K : Knowledge::fromStored(todo[i]);
+            if (K_parent != K) {
+                rebuiltParents.push_back(K_parent);
+            }
+
+            for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
+                if (considerLabel(K_parent, l)) {
+                    batch.parents.push_back(K_parent);
+                    batch.labels.push_back(l);
+                    storedParents.push_back(todo[i]);
+                }
+            }
+        }
+        batch.successors.assign(batch.labels.size(), NULL);
+        batch.next = 0;
+
+        // publish the batch and calculate the successors -- the main thread helps
+        pthread_mutex_lock(&batch.mutex);
+        batch.working = threads.size();
+        ++batch.generation;
+        pthread_cond_broadcast(&batch.published);
+        pthread_mutex_unlock(&batch.mutex);
+
+        calculateTasks(&batch);
+
+        pthread_mutex_lock(&batch.mutex);
+        while (batch.working > 0) {
+            pthread_cond_wait(&batch.calculated, &batch.mutex);
+        }
+        pthread_mutex_unlock(&batch.mutex);
+
+        // store the successors in the order of the tasks (see processSuccessor)
+        for (size_t task = 0; task < batch.labels.size(); ++task) {
+            Knowledge* const K_new = batch.successors[task];
+            StoredKnowledge* const SK_parent = storedParents[task];
+            const Label_ID& l = batch.labels[task];
+
+            // do not store and process the empty node explicitly
+            if (K_new->size == 0) {
+                if (K_new->is_sane) {
+                    SK_parent->addSuccessor(l, empty);
+                } else {
+                    ++stats.builtInsaneNodes;
+                }
+                delete K_new;
+                continue;
+            }
+
+            // only process knowledges within the message bounds
+            if (K_new->is_sane or args_info.diagnose_given) {
+                // create a compact version of the knowledge bubble
+                StoredKnowledge* SK_new = new StoredKnowledge(K_new);
+
+                // add it to the knowledge table (the Tarjan values are set later)
+                StoredKnowledge* const SK_store = knowledgeTable.insert(SK_new, SK_new->hash());
+
+                // store an edge from the parent to this node
+                SK_parent->addSuccessor(l, SK_store);
+
+                if (SK_store == SK_new) {
+                    ++stats.storedKnowledges;
+
+                    if (K_new->is_sane) {
+                        // the node was new and sane, so check its successors later
+                        todo.push_back(SK_new);
+                    }
+                } else {
+                    // we did not find new knowledge
+                    delete SK_new;
+                }
+            } else {
+                // the node was not sane -- count it
+                ++stats.builtInsaneNodes;
+            }
+
+            delete K_new;
+        }
+
+        // the successors of the batch's parents are stored
+        FOREACH(K_parent, rebuiltParents) {
+            delete *K_parent;
+        }
+        todo.erase(todo.begin(), todo.begin() + parents);
+    }
+
+    // stop the threads
+    pthread_mutex_lock(&batch.mutex);
+    batch.finished = true;
+    pthread_cond_broadcast(&batch.published);
+    pthread_mutex_unlock(&batch.mutex);
+    for (size_t t = 0; t < threads.size(); ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_cond_destroy(&batch.calculated);
+    pthread_cond_destroy(&batch.published);
+    pthread_mutex_destroy(&batch.mutex);
+
+    // detect and evaluate the SCCs
+    evaluateDepthFirst(SK);
+}
+
+
+/*!
+ Traverses the stored knowledges depth first in the same order as processNode
+ and processSuccessor calculate them. Visiting a knowledge for the first time
+ corresponds to storing it, so the Tarjan values and the Tarjan stack evolve
+ as in processNode, and so does the evaluation of the SCCs. Like processNode,
+ the traversal uses an explicit stack.
+
+ \param[in] SK  a sane knowledge that is already on the Tarjan stack
+ */
+void StoredKnowledge::evaluateDepthFirst(StoredKnowledge* const SK) {
+    // the knowledges being traversed and the positions of their current successors
+    vector<pair<StoredKnowledge*, Label_ID> > search(1, pair<StoredKnowledge*, Label_ID>(SK, 0));
+
+    // the last assigned depth-first number
+    unsigned int dfs = SK->dfs;
+
+    while (not search.empty()) {
+        StoredKnowledge* const current = search.back().first;
+        Label_ID& e = search.back().second;
+
+        if (e == current->successorCount) {
+            current->evaluateKnowledge();
+            search.pop_back();
+
+            // the successors of the successor have been evaluated, so adjust lowlink value of the parent
+            if (not search.empty()) {
+                search.back().first->adjustLowlinkValue(current, true);
+                ++search.back().second;
+            }
+            continue;
+        }
+
+        StoredKnowledge* const SK_succ = current->successors[e];
+        if (SK_succ == empty) {
+            ++e;
+            continue;
+        }
+
+        const bool newKnowledge = (SK_succ->dfs == 0);
+        if (newKnowledge) {
+            // set Tarjan values as in store()
+            SK_succ->dfs = SK_succ->lowlink = ++dfs;
+            tarjanStack.push_back(SK_succ);
+
+            if (SK_succ->is_sane) {
+                search.push_back(pair<StoredKnowledge*, Label_ID>(SK_succ, 0));
+                continue;
+            }
+        }
+
+        current->adjustLowlinkValue(SK_succ, newKnowledge);
+        ++e;
+    }
+}
+
+
 /*!
  create the predecessor relation of all knowledges contained in the given set
  and then evaluate each member of the given set of knowledges and propagate
@@ -264,16 +751,15 @@ void StoredKnowledge::analyzeSCCOfKnowledges(std::set<StoredKnowledge*>& knowled
     // first, we generate the predecessor relation between the members
     FOREACH(iScc, knowledgeSet) {
         // for each successor which is part of the current SCC, register the predecessor
-        for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-            if ((**iScc).successors[l - 1] != NULL and(**iScc).successors[l - 1] != empty and
-                    knowledgeSet.find((**iScc).successors[l - 1]) != knowledgeSet.end()) {
+        for (Label_ID e = 0; e < (**iScc).successorCount; ++e) {
+            StoredKnowledge* const SK_succ = (**iScc).successors[e];
 
-                tempPredecessors[(**iScc).successors[l - 1]].insert(*iScc);
+            if (SK_succ != empty and knowledgeSet.find(SK_succ) != knowledgeSet.end()) {
+                tempPredecessors[SK_succ].insert(*iScc);
             }
             // check if there exists a successor (within or outside of the current SCC) from which a
             // final node is reachable
-            if ((**iScc).successors[l - 1] != NULL and(**iScc).successors[l - 1] != empty and
-                    (**iScc).successors[l - 1]->is_final_reachable) {
+            if (SK_succ != empty and SK_succ->is_final_reachable) {
                 is_final_reachable = true;
             }
         }
@@ -316,28 +802,26 @@ void StoredKnowledge::rearrangeKnowledgeBubble() {
     innermarkingcount_t j = 0;
 
     while (j < sizeDeadlockMarkings) {
-        assert(interface[j]);
-
         // find out whether marking is transient
         bool transient = false;
 
         // case 1: a final marking that is not a waitstate
-        if (InnerMarking::inner_markings[inner[j]]->is_final and interface[j]->unmarked()) {
+        if (InnerMarking::isFinal(inner[j]) and interface[j].unmarked()) {
             // remember that this knowledge contains a final marking
             is_final = is_final_reachable = 1;
 
             // only if the final marking is not a waitstate, we're done
-            if (not InnerMarking::inner_markings[inner[j]]->is_waitstate) {
+            if (not InnerMarking::isWaitstate(inner[j])) {
                 transient = true;
             }
         }
 
         // case 2: a resolved waitstate
-        if (InnerMarking::inner_markings[inner[j]]->is_waitstate) {
+        if (InnerMarking::isWaitstate(inner[j])) {
             // check if DL is resolved by interface marking
             for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-                if (interface[j]->marked(l) and
-                        InnerMarking::receivers[l].find(inner[j]) != InnerMarking::receivers[l].end()) {
+                if (interface[j].marked(l) and
+                        InnerMarking::activatedBy(inner[j], l)) {
                     transient = true;
                 }
             }
@@ -349,13 +833,10 @@ void StoredKnowledge::rearrangeKnowledgeBubble() {
         // "hide" transient markings behind the end of the array
         if (transient) {
             InnerMarking_ID temp_inner = inner[j];
-            InterfaceMarking* temp_interface = interface[j];
-
             inner[j] = inner[ sizeDeadlockMarkings - 1 ];
-            interface[j] = interface[ sizeDeadlockMarkings - 1 ];
-
             inner[ sizeDeadlockMarkings - 1 ] = temp_inner;
-            interface[ sizeDeadlockMarkings - 1 ] = temp_interface;
+
+            interface[j].swap(interface[ sizeDeadlockMarkings - 1 ]);
 
             --sizeDeadlockMarkings;
         } else {
@@ -372,35 +853,50 @@ void StoredKnowledge::rearrangeKnowledgeBubble() {
 /*!
  converts a Knowledge object into a StoredKnowledge object
 
- \note The arrays for the successors is allocated with calloc to avoid a for
-       loop to set the entries to NULL.
+ All markings are stored in a single zeroed block (see markingBytes()):
+ first the interface marking objects, then the inner markings, and finally
+ the words of the interface markings unless they are stored inline. Hence,
+ the block holds no pointers behind the interface marking objects, and the
+ markings of two knowledges can be compared with a single memcmp (see
+ equals()).
+
+ \note The successors are not allocated here, but grow with each call of
+       addSuccessor().
 
  \param[in] K  the knowledge to copy from
 */
 StoredKnowledge::StoredKnowledge(const Knowledge* K)
     : is_final(0), is_final_reachable(0), is_sane(K->is_sane),
-      is_on_tarjan_stack(1), sizeDeadlockMarkings(K->size),
+      is_on_tarjan_stack(1), successorCount(0), dfs(0), lowlink(0), sizeDeadlockMarkings(K->size),
       sizeAllMarkings(K->size),
-      // reserve the necessary memory for the internal and interface markings
-      inner(new InnerMarking_ID[sizeAllMarkings]),
-      interface(new InterfaceMarking*[sizeAllMarkings]),
-      // reserve and zero the necessary memory for the successors (fixed)
-      successors((StoredKnowledge**)calloc(Label::events, SIZEOF_VOIDP)),
+      // reserve and zero the block for the internal and interface markings
+      interface(static_cast<InterfaceMarking*>(calloc(1, markingBytes(sizeAllMarkings)))),
+      inner(reinterpret_cast<InnerMarking_ID*>(interface + sizeAllMarkings)),
+      // the successors are stored by addSuccessor
+      successors(NULL),
       //s_id(K->my_id),
       s_minReceiveMessages(K->minReceiveMessages),
       s_minSendMessages(K->minSendMessages),
       s_minMessages(NULL){
+    Statistics::created(Statistics::STORED_KNOWLEDGE);
+
     assert(sizeAllMarkings > 0);
 
+    assert(interface);
+
+    // the words of the interface markings follow the inner markings
+    uint64_t* words = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(inner) + innerBytes(sizeAllMarkings));
+
     // copy data structure to C-style arrays
     innermarkingcount_t count = 0;
 
-    // traverse the bubble and copy the markings into the C arrays
+    // traverse the bubble and copy the markings into the marking block
     FOREACH(pos, K->bubble) {
-        for (innermarkingcount_t i = 0; i < pos->second.size(); ++i, ++count) {
-            // copy the inner marking and the interface marking
-            inner[count] = pos->first;
-            interface[count] = new InterfaceMarking(*(pos->second[i]));
+        // copy the inner marking and the interface marking
+        inner[count] = pos->inner;
+        new (interface + count++) InterfaceMarking(words, pos->interface);
+        if (not InterfaceMarking::inline_storage) {
+            words += InterfaceMarking::words;
         }
     }
 
@@ -417,30 +913,27 @@ StoredKnowledge::StoredKnowledge(const Knowledge* K)
 }
 
 
+/*!
+ \note The interface markings are not destructed, because their words are
+       part of the marking block, too.
+*/
 StoredKnowledge::~StoredKnowledge() {
-    // delete the interface markings
-    for (innermarkingcount_t i = 0; i < sizeAllMarkings; ++i) {
-        delete interface[i];
-    }
-    delete[] interface;
-
-    delete[] inner;
+    free(interface);
     free(successors);
 
     if (args_info.cover_given) {
         Cover::removeKnowledge(this);
     }
-
-    tarjanMapping.erase(this);
 }
 
 
 void StoredKnowledge::finalize() {
     unsigned int count = 0;
 
-    FOREACH(it, hashTree) {
-        for (size_t i = 0; i < it->second.size(); ++i, ++count) {
-            delete it->second[i];
+    for (size_t i = 0; i < knowledgeTable.capacity(); ++i) {
+        if (knowledgeTable[i] != NULL) {
+            delete knowledgeTable[i];
+            ++count;
         }
     }
 
@@ -458,16 +951,16 @@ void StoredKnowledge::finalize() {
  \param SK           new knowledge whose successors have been calculated completely
  \param newKnowledge SK has been newly created in calling function process()
 */
-void StoredKnowledge::adjustLowlinkValue(const StoredKnowledge* const SK, const bool newKnowledge) const {
+void StoredKnowledge::adjustLowlinkValue(const StoredKnowledge* const SK, const bool newKnowledge) {
     // successor node is not new
     if (not newKnowledge) {
         if (SK->is_on_tarjan_stack) {
             // but it is still on the stack, compare lowlink and dfs value
-            tarjanMapping[this].second = MINIMUM(tarjanMapping[this].second, tarjanMapping[SK].first);
+            lowlink = MINIMUM(lowlink, SK->dfs);
         }
     } else {
         // successor node is new, compare lowlink values
-        tarjanMapping[this].second = MINIMUM(tarjanMapping[this].second, tarjanMapping[SK].second);
+        lowlink = MINIMUM(lowlink, SK->lowlink);
     }
 }
 
@@ -480,7 +973,7 @@ void StoredKnowledge::evaluateKnowledge() {
 
     // check, if the current knowledge is a representative of a SCC
     // if so, get all knowledges within the SCC
-    if (tarjanMapping[this].first == tarjanMapping[this].second) {
+    if (dfs == lowlink) {
 
         unsigned int numberOfSccElements = 0;
 
@@ -493,8 +986,8 @@ void StoredKnowledge::evaluateKnowledge() {
         std::set<StoredKnowledge*> knowledgeSet;
 
         // found a TSCC
-        if (tarjanMapping[this].first > StoredKnowledge::bookmarkTSCC) {
-            StoredKnowledge::bookmarkTSCC = tarjanMapping[this].first;
+        if (dfs > StoredKnowledge::bookmarkTSCC) {
+            StoredKnowledge::bookmarkTSCC = dfs;
         }
 
         // get (T)SCC
@@ -531,61 +1024,26 @@ void StoredKnowledge::evaluateKnowledge() {
 
 
 /*!
- \return a pointer to a knowledge stored in the hash tree -- it is either
-         "this" if the knowledge was not found in the hash tree or a pointer
-         to a previously stored knowledge. In the latter case, the calling
-         function can detect the duplicate
+ \return a pointer to a knowledge stored in the knowledge table -- it is
+         either "this" if the knowledge was not found in the table or a
+         pointer to a previously stored knowledge. In the latter case, the
+         calling function can detect the duplicate
  */
 StoredKnowledge* StoredKnowledge::store() {
     // we do not want to store the empty node
     assert(sizeAllMarkings != 0);
 
-    // get the element's hash value
-    const hash_t myHash(hash());
-
-    // check if we find a bucket with that hash value
-    std::map<hash_t, std::vector<StoredKnowledge*> >::const_iterator el = hashTree.find(myHash);
-    if (el != hashTree.end()) {
-        // we found an element with the same hash -- is it a collision?
-        for (size_t i = 0; i < el->second.size(); ++i) {
-            assert(el->second[i]);
-
-            // compare the sizes
-            if (sizeAllMarkings == el->second[i]->sizeAllMarkings) {
-                // if still true after the loop, we found previously stored knowledge
-                bool found = true;
-
-                // compare the inner and interface markings
-                for (innermarkingcount_t j = 0; (j < sizeAllMarkings and found); ++j) {
-                    if (inner[j] != el->second[i]->inner[j] or
-                            *interface[j] != *el->second[i]->interface[j]) {
-                        found = false;
-                        break;
-                    }
-                }
-
-                // check if we found a previously stored knowledge
-                if (found) {
-                    // we found a previously stored element with the same
-                    // markings -> return a pointer to this element
-                    return el->second[i];
-                }
-            }
-        }
-
-        // this object was not found in the bucket -- this is a collision
-        ++stats.hashCollisions;
-
-        // update maximal bucket size (we add 1 as we will store this object later)
-        stats.maxBucketSize = MAXIMUM(stats.maxBucketSize, hashTree[myHash].size() + 1);
+    // look for a previously stored knowledge with the same markings
+    StoredKnowledge* const stored = knowledgeTable.insert(this, hash());
+    if (stored != this) {
+        return stored;
     }
 
-    // we need to store this object
-    hashTree[myHash].push_back(this);
+    // this object has been stored
     ++stats.storedKnowledges;
 
-    // set Tarjan values (first == dfs; second == lowlink)
-    tarjanMapping[this].first = tarjanMapping[this].second = stats.storedKnowledges;
+    // set Tarjan values
+    dfs = lowlink = stats.storedKnowledges;
 
     // put knowledge on the Tarjan stack
     tarjanStack.push_back(this);
@@ -595,20 +1053,116 @@ StoredKnowledge* StoredKnowledge::store() {
 }
 
 
+/*!
+ \return the number of bytes of sizeAllMarkings inner markings, padded to
+         whole 64 bit words
+*/
+size_t StoredKnowledge::innerBytes(const innermarkingcount_t sizeAllMarkings) {
+    return (sizeAllMarkings * sizeof(InnerMarking_ID) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+
+/*!
+ \return the number of bytes of the marking block of a knowledge with
+         sizeAllMarkings markings (see the constructor)
+*/
+size_t StoredKnowledge::markingBytes(const innermarkingcount_t sizeAllMarkings) {
+    return sizeAllMarkings * sizeof(InterfaceMarking) + innerBytes(sizeAllMarkings) +
+           (InterfaceMarking::inline_storage ? 0 : sizeAllMarkings * InterfaceMarking::words * sizeof(uint64_t));
+}
+
+
+/*!
+ \return the first byte of the marking block that is hashed and compared:
+         the interface marking objects only contain pointers unless their
+         words are stored inline
+*/
+const uint8_t* StoredKnowledge::comparedBytes() const {
+    return InterfaceMarking::inline_storage ?
+           reinterpret_cast<const uint8_t*>(interface) :
+           reinterpret_cast<const uint8_t*>(inner);
+}
+
+
+/*!
+ \note The hash value combines the words of the marking block in the order
+       they are stored (64 bit FNV-1a), because equal knowledges store their
+       markings in the same order.
+ */
 hash_t StoredKnowledge::hash() const {
-    hash_t result(0);
+    hash_t result(14695981039346656037ULL);
 
-    for (innermarkingcount_t i = 0; i < sizeAllMarkings; ++i) {
-        result += ((1 << i) * (inner[i]) + interface[i]->hash());
+    const uint64_t* const begin = reinterpret_cast<const uint64_t*>(comparedBytes());
+    const uint64_t* const end = reinterpret_cast<const uint64_t*>(
+                                    reinterpret_cast<const uint8_t*>(interface) + markingBytes(sizeAllMarkings));
+    for (const uint64_t* word = begin; word != end; ++word) {
+        result = (result ^ *word) * 1099511628211ULL;
     }
 
     return result;
 }
 
 
+/*!
+ \param[in] other  a stored knowledge with the same hash value
+
+ \return whether both knowledges consist of the same inner and interface
+         markings
+ */
+bool StoredKnowledge::equals(const StoredKnowledge* const other) const {
+    // compare the sizes
+    if (sizeAllMarkings != other->sizeAllMarkings) {
+        return false;
+    }
+
+    // compare the inner and interface markings (the padding is zeroed)
+    const uint8_t* const begin = comparedBytes();
+    const size_t length = reinterpret_cast<const uint8_t*>(interface) + markingBytes(sizeAllMarkings) - begin;
+    return (memcmp(begin, other->comparedBytes(), length) == 0);
+}
+
+
+/*!
+ The successors are stored in a single block that holds successorCount
+ pointers followed by successorCount labels, both sorted by the labels. As
+ the labels are processed in ascending order, a new successor is usually
+ appended to the end.
+
+ \param[in] label      the label of the edge (never tau)
+ \param[in] knowledge  the successor knowledge (never NULL)
+*/
 void StoredKnowledge::addSuccessor(const Label_ID& label, StoredKnowledge* const knowledge) {
-    // we will never store label 0 (tau) -- hence decrease the label
-    successors[label - 1] = knowledge;
+    assert(label != 0);
+    assert(knowledge);
+
+    // find the position of the label
+    const Label_ID* const labels = successorLabels();
+    Label_ID pos = 0;
+    while (pos < successorCount and labels[pos] < label) {
+        ++pos;
+    }
+
+    // an edge with this label is already stored
+    if (pos < successorCount and labels[pos] == label) {
+        successors[pos] = knowledge;
+        return;
+    }
+
+    // grow the block by one pointer and one label
+    const Label_ID count = successorCount;
+    assert(count < Label::events);
+    successors = (StoredKnowledge**)realloc(successors, (count + 1) * (SIZEOF_VOIDP + sizeof(Label_ID)));
+
+    // move the labels behind the (grown) pointers, then the pointers after pos
+    Label_ID* const oldLabels = reinterpret_cast<Label_ID*>(successors + count);
+    Label_ID* const newLabels = reinterpret_cast<Label_ID*>(successors + count + 1);
+    memmove(newLabels + pos + 1, oldLabels + pos, (count - pos) * sizeof(Label_ID));
+    memmove(newLabels, oldLabels, pos * sizeof(Label_ID));
+    memmove(successors + pos + 1, successors + pos, (count - pos) * SIZEOF_VOIDP);
+
+    successors[pos] = knowledge;
+    newLabels[pos] = label;
+    ++successorCount;
 
     // statistics output
     if (args_info.reportFrequency_arg and ++stats.storedEdges % args_info.reportFrequency_arg == 0) {
@@ -617,6 +1171,42 @@ void StoredKnowledge::addSuccessor(const Label_ID& label, StoredKnowledge* const
 }
 
 
+/*!
+ \param[in] label  the label of the edge to remove; nothing happens if this
+                   knowledge has no successor for this label
+*/
+void StoredKnowledge::removeSuccessor(const Label_ID& label) {
+    const Label_ID* const labels = successorLabels();
+    Label_ID pos = 0;
+    while (pos < successorCount and labels[pos] != label) {
+        ++pos;
+    }
+
+    if (pos == successorCount) {
+        return;
+    }
+
+    // close the gap in the pointers, then move the labels behind them
+    const Label_ID count = successorCount;
+    memmove(successors + pos, successors + pos + 1, (count - pos - 1) * SIZEOF_VOIDP);
+    Label_ID* const oldLabels = reinterpret_cast<Label_ID*>(successors + count);
+    Label_ID* const newLabels = reinterpret_cast<Label_ID*>(successors + count - 1);
+    memmove(newLabels, oldLabels, pos * sizeof(Label_ID));
+    memmove(newLabels + pos, oldLabels + pos + 1, (count - pos - 1) * sizeof(Label_ID));
+    --successorCount;
+}
+
+
+/*!
+ \return the bytes of this object, its markings, and its successors (the
+         arrays for the test guidelines are not counted)
+*/
+size_t StoredKnowledge::memory() const {
+    return sizeof(StoredKnowledge) + markingBytes(sizeAllMarkings) +
+           successorCount * (SIZEOF_VOIDP + sizeof(Label_ID));
+}
+
+
 /*!
  \return whether each deadlock in the knowledge is resolved
 
@@ -631,20 +1221,23 @@ bool StoredKnowledge::sat(const bool checkOnTarjanStack) {
 
     bool is_on_tarjan_stack = false;
 
+    const Label_ID* const labels = successorLabels();
+
     // if we find a sending successor, this node is OK
-    for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-        if (successors[l - 1] != NULL and successors[l - 1] != empty and successors[l - 1]->is_sane) {
+    for (Label_ID e = 0; e < successorCount; ++e) {
+        StoredKnowledge* const SK_succ = successors[e];
+        if (SENDING(labels[e]) and SK_succ != empty and SK_succ->is_sane) {
 
-            if (checkOnTarjanStack and successors[l - 1]->is_on_tarjan_stack) {
+            if (checkOnTarjanStack and SK_succ->is_on_tarjan_stack) {
                 is_on_tarjan_stack = true;
                 continue;
             }
 
-            if (args_info.correctness_arg == correctness_arg_livelock and not successors[l - 1]->is_final_reachable) {
+            if (args_info.correctness_arg == correctness_arg_livelock and not SK_succ->is_final_reachable) {
                 continue;
             }
 
-            is_final_reachable = successors[l - 1]->is_final_reachable;
+            is_final_reachable = SK_succ->is_final_reachable;
 
             return true;
         }
@@ -658,21 +1251,21 @@ bool StoredKnowledge::sat(const bool checkOnTarjanStack) {
 
         // we found a deadlock -- check whether for at least one marked
         // output place exists a respective receiving edge
-        for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
+        for (Label_ID e = 0; e < successorCount and RECEIVING(labels[e]); ++e) {
+            StoredKnowledge* const SK_succ = successors[e];
 
-            if (interface[i]->marked(l) and successors[l - 1] != NULL and successors[l - 1] != empty and
-                    successors[l - 1]->is_sane) {
+            if (interface[i].marked(labels[e]) and SK_succ != empty and SK_succ->is_sane) {
 
-                if (checkOnTarjanStack and successors[l - 1]->is_on_tarjan_stack) {
+                if (checkOnTarjanStack and SK_succ->is_on_tarjan_stack) {
                     is_on_tarjan_stack = true;
                     continue;
                 }
 
-                if (args_info.correctness_arg == correctness_arg_livelock and not successors[l - 1]->is_final_reachable) {
+                if (args_info.correctness_arg == correctness_arg_livelock and not SK_succ->is_final_reachable) {
                     continue;
                 }
 
-                is_final_reachable = successors[l - 1]->is_final_reachable;
+                is_final_reachable = SK_succ->is_final_reachable;
 
                 resolved = true;
                 break;
@@ -685,20 +1278,22 @@ bool StoredKnowledge::sat(const bool checkOnTarjanStack) {
         }
 
         // check if a synchronous action can resolve this deadlock
-        for (Label_ID l = Label::first_sync; l <= Label::last_sync; ++l) {
-            if (InnerMarking::synchs[l].find(inner[i]) != InnerMarking::synchs[l].end() and
-                    successors[l - 1] != NULL and successors[l - 1] != empty and successors[l - 1]->is_sane) {
+        for (Label_ID e = 0; e < successorCount; ++e) {
+            StoredKnowledge* const SK_succ = successors[e];
+
+            if (SYNC(labels[e]) and InnerMarking::activatedBy(inner[i], labels[e]) and
+                    SK_succ != empty and SK_succ->is_sane) {
 
-                if (checkOnTarjanStack and successors[l - 1]->is_on_tarjan_stack) {
+                if (checkOnTarjanStack and SK_succ->is_on_tarjan_stack) {
                     is_on_tarjan_stack = true;
                     continue;
                 }
 
-                if (args_info.correctness_arg == correctness_arg_livelock and not successors[l - 1]->is_final_reachable) {
+                if (args_info.correctness_arg == correctness_arg_livelock and not SK_succ->is_final_reachable) {
                     continue;
                 }
 
-                is_final_reachable = successors[l - 1]->is_final_reachable;
+                is_final_reachable = SK_succ->is_final_reachable;
 
                 resolved = true;
                 break;
@@ -706,7 +1301,7 @@ bool StoredKnowledge::sat(const bool checkOnTarjanStack) {
         }
 
         // the deadlock is neither resolved nor a final marking
-        if (not resolved and not(InnerMarking::inner_markings[inner[i]]->is_final and interface[i]->unmarked()) and not args_info.tg_given) {
+        if (not resolved and not(InnerMarking::isFinal(inner[i]) and interface[i].unmarked()) and not args_info.tg_given) {
             return false;
         }
     }
@@ -725,16 +1320,84 @@ bool StoredKnowledge::sat(const bool checkOnTarjanStack) {
 }
 
 
+/*!
+ \param[in] K     the knowledge (explicitly stored)
+ \param[in] last  the label whose successor has been processed last; the
+                  successors for later labels are still to calculate
+
+ \return whether this node is not satisfied (see sat()) even if the
+         successors still to calculate are sane
+
+ \note Successors on the Tarjan stack are assumed to stay sane, so the
+       result is conservative.
+ */
+bool StoredKnowledge::unsatisfiable(const Knowledge* const K, const Label_ID& last) const {
+    // a sending successor may still satisfy this node
+    for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
+        if (mayResolve(K, l, last)) {
+            return false;
+        }
+    }
+
+    // each deadlock must still be resolvable by a receiving or synchronous successor
+    for (innermarkingcount_t i = 0; i < sizeDeadlockMarkings; ++i) {
+        if (InnerMarking::isFinal(inner[i]) and interface[i].unmarked()) {
+            continue;
+        }
+
+        bool resolvable = false;
+        for (Label_ID l = Label::first_receive; l <= Label::last_receive and not resolvable; ++l) {
+            resolvable = interface[i].marked(l) and mayResolve(K, l, last);
+        }
+        for (Label_ID l = Label::first_sync; l <= Label::last_sync and not resolvable; ++l) {
+            resolvable = InnerMarking::activatedBy(inner[i], l) and mayResolve(K, l, last);
+        }
+
+        if (not resolvable) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*!
+ \param[in] K     the knowledge (explicitly stored)
+ \param[in] l     a label
+ \param[in] last  the label whose successor has been processed last
+
+ \return whether the successor for label l is still to calculate (and not
+         excluded by a reduction rule) or is a sane knowledge
+ */
+bool StoredKnowledge::mayResolve(const Knowledge* const K, const Label_ID& l, const Label_ID& last) const {
+    if (l > last) {
+        return considerLabel(K, l);
+    }
+
+    const StoredKnowledge* const SK_succ = successor(l);
+    return (SK_succ != NULL and SK_succ != empty and SK_succ->is_sane);
+}
+
+
 /*!
  \post All nodes that are reachable from the initial node are added to the
        set "seen".
  */
 void StoredKnowledge::traverse() {
-    if (seen.insert(this).second) {
-        for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-            if (successors[l - 1] != NULL and successors[l - 1] != empty and
-                    (successors[l - 1]->is_sane or args_info.diagnose_given)) {
-                successors[l - 1]->traverse();
+    // the knowledges whose successors still need to be visited
+    vector<StoredKnowledge*> search(1, this);
+
+    while (not search.empty()) {
+        StoredKnowledge* const SK = search.back();
+        search.pop_back();
+
+        if (seen.insert(SK).second) {
+            for (Label_ID e = 0; e < SK->successorCount; ++e) {
+                if (SK->successors[e] != empty and
+                        (SK->successors[e]->is_sane or args_info.diagnose_given)) {
+                    search.push_back(SK->successors[e]);
+                }
             }
         }
     }
@@ -869,17 +1532,17 @@ void StoredKnowledge::print(std::ostream& file) const {
 
     file << "\n";
 
-    for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-        if (successors[l - 1] != NULL and
-                successors[l - 1] != empty and
-                (seen.find(successors[l - 1]) != seen.end())) {
-            file << "    " << Label::id2name[l] << " -> "
-                 << reinterpret_cast<size_t>(successors[l - 1])
+    const Label_ID* const labels = successorLabels();
+    for (Label_ID e = 0; e < successorCount; ++e) {
+        if (successors[e] != empty and
+                (seen.find(successors[e]) != seen.end())) {
+            file << "    " << Label::id2name[labels[e]] << " -> "
+                 << reinterpret_cast<size_t>(successors[e])
                  << "\n";
         } else {
-            if (successors[l - 1] == empty and not args_info.sa_given) {
+            if (successors[e] == empty and not args_info.sa_given) {
                 emptyNodeReachable = true;
-                file << "    " << Label::id2name[l] << " -> 0\n";
+                file << "    " << Label::id2name[labels[e]] << " -> 0\n";
             }
         }
     }
@@ -903,11 +1566,13 @@ std::string StoredKnowledge::formula(bool dot) const {
 
     unsigned int countLiterals = 0;
 
+    const Label_ID* const labels = successorLabels();
+
     // collect outgoing !-edges
-    for (Label_ID l = Label::first_send; l <= Label::last_send; ++l) {
-        if (successors[l - 1] != NULL and successors[l - 1]->is_sane) {
+    for (Label_ID e = 0; e < successorCount; ++e) {
+        if (SENDING(labels[e]) and successors[e]->is_sane) {
 
-            sendDisjunction.insert(Label::id2name[l]);
+            sendDisjunction.insert(Label::id2name[labels[e]]);
         }
     }
 
@@ -920,35 +1585,31 @@ std::string StoredKnowledge::formula(bool dot) const {
         // add sending events to current disjunction
         set<string> disjunctionSendingReceivingSynchronous(sendDisjunction);
 
-        // receiving event
-        for (Label_ID l = Label::first_receive; l <= Label::last_receive; ++l) {
+        for (Label_ID e = 0; e < successorCount; ++e) {
+            const Label_ID& l = labels[e];
+
             // receiving event resolves deadlock
-            if (interface[i]->marked(l) and
-                    successors[l - 1] != NULL and successors[l - 1] != empty and
-                    successors[l - 1]->is_sane) {
+            if (RECEIVING(l) and interface[i].marked(l) and
+                    successors[e] != empty and successors[e]->is_sane) {
 
                 disjunctionSendingReceivingSynchronous.insert(Label::id2name[l]);
             }
-        }
 
-        // synchronous communication
-        for (Label_ID l = Label::first_sync; l <= Label::last_sync; ++l) {
             // synchronous communication resolves deadlock
-            if (InnerMarking::synchs[l].find(inner[i]) != InnerMarking::synchs[l].end() and
-                    successors[l - 1] != NULL and successors[l - 1] != empty and
-                    successors[l - 1]->is_sane) {
+            if (SYNC(l) and InnerMarking::activatedBy(inner[i], l) and
+                    successors[e] != empty and successors[e]->is_sane) {
 
                 disjunctionSendingReceivingSynchronous.insert(Label::id2name[l]);
             }
         }
 
         // deadlock is final
-        if (not args_info.tg_given and interface[i]->unmarked() and InnerMarking::inner_markings[inner[i]]->is_final) {
+        if (not args_info.tg_given and interface[i].unmarked() and InnerMarking::isFinal(inner[i])) {
             disjunctionSendingReceivingSynchronous.insert("final");
         }
 
         // final for TG
-        if (args_info.tg_given and interface[i]->receiveUnmarked() and InnerMarking::inner_markings[inner[i]]->is_final) {
+        if (args_info.tg_given and interface[i].receiveUnmarked() and InnerMarking::isFinal(inner[i])) {
         	if (args_info.format_arg == format_arg_tgConform){
         		isFinal = true;
         	}
@@ -1067,100 +1728,101 @@ void StoredKnowledge::output_dot(std::ostream& file) {
     file << "INIT -> \"" << root << "\" [minlen=\"0.5\"]" << "\n";
 
     // draw the nodes
-    FOREACH(it, hashTree) {
-        for (size_t i = 0; i < it->second.size(); ++i) {
-            if ((it->second[i]->is_sane or args_info.diagnose_given) and
-                    (seen.find(it->second[i]) != seen.end())) {
-
-                file << "\"" << it->second[i] << "\" [label=\"";
-
-                // livelock operating guideline has been calculated
-                if (args_info.correctness_arg == correctness_arg_livelock and args_info.og_given) {
-                    if (not args_info.showInternalNodeNames_flag) {
-                        if (nodeMapping.find(it->second[i]) == nodeMapping.end()) {
-                            nodeMapping[it->second[i]] = nodeMapping.size();
-                        }
-                        // formula is not shown, but node number is shown
-                        file << nodeMapping[it->second[i]] << "\\n";
-                    } else {
-                        // formula is not shown, but node number is shown
-                        file << reinterpret_cast<size_t>(it->second[i]) << "\\n";
-                    }
-                } else if (not args_info.sa_given) {
-                    // show only formula
-                    file << it->second[i]->formula(true) << "\\n";
-                }
+    for (size_t i = 0; i < knowledgeTable.capacity(); ++i) {
+        StoredKnowledge* const SK = knowledgeTable[i];
 
-                if (args_info.diagnose_given and not it->second[i]->is_sane) {
-                    file << "is not sane\\n";
-                }
+        if (SK != NULL and (SK->is_sane or args_info.diagnose_given) and
+                (seen.find(SK) != seen.end())) {
+
+            file << "\"" << SK << "\" [label=\"";
 
-                if (args_info.showWaitstates_flag) {
-                    for (innermarkingcount_t j = 0; j < it->second[i]->sizeDeadlockMarkings; ++j) {
-                        file << "m" << static_cast<size_t>(it->second[i]->inner[j]) << " ";
-                        file << *(it->second[i]->interface[j]) << " (w)\\n";
+            // livelock operating guideline has been calculated
+            if (args_info.correctness_arg == correctness_arg_livelock and args_info.og_given) {
+                if (not args_info.showInternalNodeNames_flag) {
+                    if (nodeMapping.find(SK) == nodeMapping.end()) {
+                        nodeMapping[SK] = nodeMapping.size();
                     }
+                    // formula is not shown, but node number is shown
+                    file << nodeMapping[SK] << "\\n";
+                } else {
+                    // formula is not shown, but node number is shown
+                    file << reinterpret_cast<size_t>(SK) << "\\n";
                 }
+            } else if (not args_info.sa_given) {
+                // show only formula
+                file << SK->formula(true) << "\\n";
+            }
 
-                if (args_info.showTransients_flag) {
-                    for (innermarkingcount_t j = it->second[i]->sizeDeadlockMarkings; j < it->second[i]->sizeAllMarkings; ++j) {
-                        file << "m" << static_cast<size_t>(it->second[i]->inner[j]) << " ";
-                        file << *(it->second[i]->interface[j]) << " (t)\\n";
-                    }
+            if (args_info.diagnose_given and not SK->is_sane) {
+                file << "is not sane\\n";
+            }
+
+            if (args_info.showWaitstates_flag) {
+                for (innermarkingcount_t j = 0; j < SK->sizeDeadlockMarkings; ++j) {
+                    file << "m" << static_cast<size_t>(SK->inner[j]) << " ";
+                    file << SK->interface[j] << " (w)\\n";
                 }
+            }
 
-                if (args_info.tg_given and args_info.verbose_given and Label::last_send - Label::first_send >= 0){
-                	Label_ID current_pos;
-                	file << "R: [";
-                	for(Label_ID l1 = Label::first_receive; l1 < Label::last_receive + 1; ++l1){
-                		current_pos = l1 - Label::first_receive;
-                		assert(it->second[i]->s_minReceiveMessages != NULL);
-                		file << (int) it->second[i]->s_minReceiveMessages[current_pos] << ",";
-
-                	}
-                	file << " ]\\n";
-                	file << "S: [";
-                	for(Label_ID l1 = Label::first_send; l1 < Label::last_send + 1; ++l1){
-                		current_pos = l1 - Label::first_send;
-                		assert(it->second[i]->s_minSendMessages != NULL);
-                		file << (int) it->second[i]->s_minSendMessages[current_pos] << ",";
-
-                	}
-                	file << " ]\\n";
-                	file << "M: [";
-                	for(Label_ID l1 = Label::first_send; l1 < Label::last_send + 1; ++l1){
-                		current_pos = l1 - Label::first_send;
-                		assert(it->second[i]->s_minMessages != NULL);
-                		file << (int) it->second[i]->s_minMessages[current_pos] << ",";
-
-                	}
-                	file << " ]\\n";
-                	//file << it->second[i]->s_id << "\\n";
+            if (args_info.showTransients_flag) {
+                for (innermarkingcount_t j = SK->sizeDeadlockMarkings; j < SK->sizeAllMarkings; ++j) {
+                    file << "m" << static_cast<size_t>(SK->inner[j]) << " ";
+                    file << SK->interface[j] << " (t)\\n";
                 }
+            }
 
+            if (args_info.tg_given and args_info.verbose_given and Label::last_send - Label::first_send >= 0){
+            	Label_ID current_pos;
+            	file << "R: [";
+            	for(Label_ID l1 = Label::first_receive; l1 < Label::last_receive + 1; ++l1){
+            		current_pos = l1 - Label::first_receive;
+            		assert(SK->s_minReceiveMessages != NULL);
+            		file << (int) SK->s_minReceiveMessages[current_pos] << ",";
+
+            	}
+            	file << " ]\\n";
+            	file << "S: [";
+            	for(Label_ID l1 = Label::first_send; l1 < Label::last_send + 1; ++l1){
+            		current_pos = l1 - Label::first_send;
+            		assert(SK->s_minSendMessages != NULL);
+            		file << (int) SK->s_minSendMessages[current_pos] << ",";
+
+            	}
+            	file << " ]\\n";
+            	file << "M: [";
+            	for(Label_ID l1 = Label::first_send; l1 < Label::last_send + 1; ++l1){
+            		current_pos = l1 - Label::first_send;
+            		assert(SK->s_minMessages != NULL);
+            		file << (int) SK->s_minMessages[current_pos] << ",";
+
+            	}
+            	file << " ]\\n";
+            	//file << SK->s_id << "\\n";
+            }
 
 
-                file << "\"]\n";
 
-                // draw the edges
-                for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-                    if (it->second[i]->successors[l - 1] != NULL and
-                            (seen.find(it->second[i]->successors[l - 1]) != seen.end()) and
-                            (args_info.showEmptyNode_flag or it->second[i]->successors[l - 1] != empty)) {
-                        file << "\"" << it->second[i] << "\" -> \""
-                             << it->second[i]->successors[l - 1]
-                             << "\" [label=\"" << PREFIX(l)
-                             << Label::id2name[l] << "\"]\n";
-                    }
+            file << "\"]\n";
 
-                    // draw edges to the empty node if requested
-                    if (args_info.showEmptyNode_flag and
-                            it->second[i]->successors[l - 1] == empty) {
-                        emptyNodeReachable = true;
-                        file << "\"" << it->second[i] << "\" -> 0"
-                             << " [label=\"" << PREFIX(l)
-                             << Label::id2name[l] << "\"]\n";
-                    }
+            // draw the edges
+            for (Label_ID e = 0; e < SK->successorCount; ++e) {
+                const Label_ID& l = SK->successorLabels()[e];
+
+                if ((seen.find(SK->successors[e]) != seen.end()) and
+                        (args_info.showEmptyNode_flag or SK->successors[e] != empty)) {
+                    file << "\"" << SK << "\" -> \""
+                         << SK->successors[e]
+                         << "\" [label=\"" << PREFIX(l)
+                         << Label::id2name[l] << "\"]\n";
+                }
+
+                // draw edges to the empty node if requested
+                if (args_info.showEmptyNode_flag and
+                        SK->successors[e] == empty) {
+                    emptyNodeReachable = true;
+                    file << "\"" << SK << "\" -> 0"
+                         << " [label=\"" << PREFIX(l)
+                         << Label::id2name[l] << "\"]\n";
                 }
             }
         }
@@ -1186,7 +1848,7 @@ void StoredKnowledge::output_migration(std::ostream& o) {
         // traverse the bubble
         for (innermarkingcount_t i = 0; i < (**it).sizeAllMarkings; ++i) {
             InnerMarking_ID inner = (**it).inner[i];
-            InterfaceMarking* interface = (**it).interface[i];
+            InterfaceMarking* interface = &(**it).interface[i];
             StoredKnowledge* knowledge = *it;
 
             migrationInfo[inner][knowledge].insert(interface);
@@ -1230,12 +1892,41 @@ void StoredKnowledge::output_results(Results& r) {
     r.add("controllability.message_bound", args_info.messagebound_arg);
 
     r.add("statistics.nodes", stats.storedKnowledges);
-    r.add("statistics.nodes_sane", static_cast<unsigned int>(seen.size()));
     r.add("statistics.nodes_insane", stats.builtInsaneNodes);
+
+    // the sane knowledges are only collected when not only deciding controllability
+    if (args_info.decideOnly_flag) {
+        r.add("statistics.successors_skipped", stats.skippedSuccessors);
+    } else {
+        r.add("statistics.nodes_sane", static_cast<unsigned int>(seen.size()));
+    }
     r.add("statistics.edges", stats.storedEdges);
-    r.add("statistics.hash_buckets_capacity", (1 << (sizeof(hash_t) * 8)));
-    r.add("statistics.hash_buckets_used", static_cast<unsigned int>(hashTree.size()));
-    r.add("statistics.hash_buckets_maximal_size", static_cast<unsigned int>(stats.maxBucketSize));
+
+    // measure the memory of the stored knowledges
+    size_t knowledgeBytes = 0;
+    size_t successorBytes = 0;
+    for (size_t i = 0; i < knowledgeTable.capacity(); ++i) {
+        const StoredKnowledge* const SK = knowledgeTable[i];
+        if (SK) {
+            knowledgeBytes += SK->memory();
+            successorBytes += SK->successorCount * (SIZEOF_VOIDP + sizeof(Label_ID));
+        }
+    }
+    const float storedKnowledges = knowledgeTable.size() ? static_cast<float>(knowledgeTable.size()) : 1;
+    r.add("statistics.bytes_per_node", knowledgeBytes / storedKnowledges);
+    r.add("statistics.successor_bytes_per_node", successorBytes / storedKnowledges);
+
+    size_t maximalProbeLength = 0;
+    float averageProbeLength = 0;
+    knowledgeTable.probeLengths(maximalProbeLength, averageProbeLength);
+    r.add("statistics.hash_table_capacity", static_cast<unsigned int>(knowledgeTable.capacity()));
+    r.add("statistics.hash_table_used", static_cast<unsigned int>(knowledgeTable.size()));
+    r.add("statistics.hash_table_load_factor", knowledgeTable.loadFactor());
+    r.add("statistics.hash_table_resizes", knowledgeTable.resizes);
+    r.add("statistics.hash_table_collisions", knowledgeTable.collisions);
+    r.add("statistics.hash_table_probe_length_maximal", static_cast<unsigned int>(maximalProbeLength));
+    r.add("statistics.hash_table_probe_length_average", averageProbeLength);
+
     r.add("statistics.queue_maximal_length", static_cast<unsigned int>(Queue::maximal_length));
     r.add("statistics.queue_reserved_length", static_cast<unsigned int>(Queue::initial_length));
     r.add("statistics.queue_maximal_queues", static_cast<unsigned int>(Queue::maximal_objects));
@@ -1288,49 +1979,51 @@ void StoredKnowledge::output_results(Results& r) {
 
         std::vector<std::size_t> finalStates;
         std::stringstream temp;
+        bool firstState = true;
 
-        FOREACH(it, hashTree) {
-            for (size_t i = 0; i < it->second.size(); ++i) {
-                if (it->second[i]->is_sane) {
+        for (size_t i = 0; i < knowledgeTable.capacity(); ++i) {
+            StoredKnowledge* const SK = knowledgeTable[i];
 
-                    if (it != hashTree.begin() or i != 0) {
-                        temp << ",\n";
-                    }
+            if (SK != NULL and SK->is_sane) {
+                if (not firstState) {
+                    temp << ",\n";
+                }
+                firstState = false;
 
-                    temp << "    { id = " << reinterpret_cast<size_t>(it->second[i]) << ";\n";
-                    if (it->second[i]->is_final) {
-                        finalStates.push_back(reinterpret_cast<size_t>(it->second[i]));
-                    }
+                temp << "    { id = " << reinterpret_cast<size_t>(SK) << ";\n";
+                if (SK->is_final) {
+                    finalStates.push_back(reinterpret_cast<size_t>(SK));
+                }
 
-                    if (not args_info.sa_given) {
-                        temp << "      formula = \"" << it->second[i]->formula(true) << "\";\n";
-                    }
+                if (not args_info.sa_given) {
+                    temp << "      formula = \"" << SK->formula(true) << "\";\n";
+                }
 
-                    bool firstSuccessor = true;
-                    temp << "      successors = (";
-                    // draw the edges
-                    for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
-                        if (it->second[i]->successors[l - 1] != NULL and
-                                (seen.find(it->second[i]->successors[l - 1]) != seen.end()) and
-                                (args_info.showEmptyNode_flag or it->second[i]->successors[l - 1] != empty)) {
-
-                            if (not firstSuccessor) {
-                                temp << ", ";
-                            }
-                            temp << "(\"" << Label::id2name[l] << "\", "
-                                 << reinterpret_cast<size_t>(it->second[i]->successors[l - 1]) << ")";
-                            firstSuccessor = false;
-                        }
+                bool firstSuccessor = true;
+                temp << "      successors = (";
+                // draw the edges
+                for (Label_ID e = 0; e < SK->successorCount; ++e) {
+                    const Label_ID& l = SK->successorLabels()[e];
+
+                    if ((seen.find(SK->successors[e]) != seen.end()) and
+                            (args_info.showEmptyNode_flag or SK->successors[e] != empty)) {
 
-                        // draw edges to the empty node if requested
-                        if (args_info.showEmptyNode_flag and
-                                it->second[i]->successors[l - 1] == empty) {
-                            emptyNodeReachable = true;
-                            temp << "(\"" << Label::id2name[l] << "\", " << 0 << ")";
+                        if (not firstSuccessor) {
+                            temp << ", ";
                         }
+                        temp << "(\"" << Label::id2name[l] << "\", "
+                             << reinterpret_cast<size_t>(SK->successors[e]) << ")";
+                        firstSuccessor = false;
+                    }
+
+                    // draw edges to the empty node if requested
+                    if (args_info.showEmptyNode_flag and
+                            SK->successors[e] == empty) {
+                        emptyNodeReachable = true;
+                        temp << "(\"" << Label::id2name[l] << "\", " << 0 << ")";
                     }
-                    temp << "); }";
                 }
+                temp << "); }";
             }
         }
 
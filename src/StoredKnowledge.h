@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include "Knowledge.h"
+#include "KnowledgeTable.h"
 #include "Results.h"
 
 
@@ -32,22 +33,31 @@
  \brief knowledge (data structure for storing knowledges)
  */
 class StoredKnowledge {
-        /// the Diagnosis needs to traverse the hash tree
+        /// the Diagnosis needs to traverse the knowledge table
         friend class Diagnosis;
 
+        /// the knowledge table compares knowledges
+        friend class KnowledgeTable;
+
+        /// a knowledge can be rebuilt from its markings
+        friend class Knowledge;
+
         /// calculation of a livelock operating guideline needs access to successors
         friend class LivelockOperatingGuideline;
         friend class CompositeMarking;
         friend class CompositeMarkingsHandler;
-        friend class SCSHandler;
+        friend class StronglyConnectedSets;
 
     public: /* static functions */
         /// destroy all objects of this class
         static void finalize();
 
-        /// recursively calculate knowledge bubbles
+        /// calculate knowledge bubbles depth first
         static void processNode(Knowledge* const, StoredKnowledge* const);
 
+        /// calculate knowledge bubbles using several threads
+        static void processNodeParallel(Knowledge* const, StoredKnowledge* const);
+
         /// print a dot representation
         static void output_dot(std::ostream&);
 
@@ -66,19 +76,13 @@ class StoredKnowledge {
             /// constructor
             _stats();
 
-            /// the number of hash collisions (distinct knowledges with the same hash value)
-            unsigned int hashCollisions;
-
             /// the number of edges stored overall
             unsigned int storedEdges;
 
             /// the number of nodes that were built, but immediately detected insane
             unsigned int builtInsaneNodes;
 
-            /// maximal size of a hash bucket (1 means no collisions)
-            size_t maxBucketSize;
-
-            /// the number of knowledges stored in the hash tree
+            /// the number of knowledges stored in the knowledge table
             unsigned int storedKnowledges;
 
             /// maximum number of scc components
@@ -89,10 +93,13 @@ class StoredKnowledge {
 
             /// number of trivial SCCs
             unsigned int numberOfTrivialSCCs;
+
+            /// the number of successors not calculated, because controllability was already decided
+            unsigned int skippedSuccessors;
         } stats;
 
-        /// buckets of knowledges, indexed by hash values
-        static std::map<hash_t, std::vector<StoredKnowledge*> > hashTree;
+        /// the stored knowledges, indexed by their hash values
+        static KnowledgeTable knowledgeTable;
 
         /// the root knowledge
         static StoredKnowledge* root;
@@ -102,9 +109,6 @@ class StoredKnowledge {
 
     private: /* static attributes */
 
-        /// maps dfs (first) and lowlink (second) number to a stored knowledge which is still on the Tarjan stack
-        static std::map<const StoredKnowledge*, std::pair<unsigned int, unsigned int> > tarjanMapping;
-
         /// the empty knowledge (just a placeholder, no object!)
         static StoredKnowledge* empty;
 
@@ -122,7 +126,28 @@ class StoredKnowledge {
 
     private: /* static functions */
         /// generate the successor of a knowledge bubble given a label
-        inline static void processSuccessor(const Knowledge*, StoredKnowledge* const, const Label_ID&);
+        inline static Knowledge* processSuccessor(const Knowledge*, StoredKnowledge* const, const Label_ID&);
+
+        /// whether the successors for the labels after the given one are to be calculated (reduction rules)
+        inline static bool considerNextLabel(const Knowledge* const, StoredKnowledge* const, Label_ID&);
+
+        /// whether the sanity of a knowledge is decided by its successors for the labels up to the given one
+        static bool decided(const Knowledge* const, StoredKnowledge* const, const Label_ID&);
+
+        /// evaluate a knowledge bubble whose successors have been calculated
+        static void finishNode(Knowledge* const, StoredKnowledge* const);
+
+        /// whether the successor of a knowledge for a label is to be calculated (reduction rules)
+        inline static bool considerLabel(const Knowledge* const, const Label_ID&);
+
+        /// calculate the successor knowledges of all batches (thread function)
+        static void* calculateSuccessors(void*);
+
+        /// calculate successor knowledges of the current batch until no task is left
+        static void calculateTasks(void*);
+
+        /// evaluate stored knowledges in the order processNode would have calculated them
+        static void evaluateDepthFirst(StoredKnowledge* const);
 
         /// creates the header for output files
         static void fileHeader(std::ostream&);
@@ -130,6 +155,12 @@ class StoredKnowledge {
         /// evaluate each member of the given (T)SCC and propagate the property of being insane accordingly
         inline static void analyzeSCCOfKnowledges(std::set<StoredKnowledge*>&);
 
+        /// the number of bytes of the inner markings of a knowledge (padded to whole words)
+        inline static size_t innerBytes(const innermarkingcount_t);
+
+        /// the number of bytes of the marking block of a knowledge
+        inline static size_t markingBytes(const innermarkingcount_t);
+
     public: /* member functions */
         /// constructs an object from a Knowledge object
         explicit StoredKnowledge(const Knowledge*);
@@ -137,7 +168,7 @@ class StoredKnowledge {
         /// destructor
         ~StoredKnowledge();
 
-        /// stores this object in the hash tree and returns a pointer to the result
+        /// stores this object in the knowledge table and returns a pointer to the result
         StoredKnowledge* store();
 
         /// traverse knowledges
@@ -147,17 +178,48 @@ class StoredKnowledge {
         /// adds a successor knowledge
         inline void addSuccessor(const Label_ID&, StoredKnowledge* const);
 
+        /// removes the successor knowledge for a label
+        void removeSuccessor(const Label_ID&);
+
+        /// the labels of the successors (successorCount entries behind the pointers)
+        inline const Label_ID* successorLabels() const {
+            return reinterpret_cast<const Label_ID*>(successors + successorCount);
+        }
+
+        /// the successor knowledge for a label (or NULL if there is none)
+        inline StoredKnowledge* successor(const Label_ID& l) const {
+            const Label_ID* const labels = successorLabels();
+            for (Label_ID e = 0; e < successorCount and labels[e] <= l; ++e) {
+                if (labels[e] == l) {
+                    return successors[e];
+                }
+            }
+            return NULL;
+        }
+
         /// return whether this node fulfills its annotation
         bool sat(const bool = false);
 
+        /// return whether this node cannot fulfill its annotation with the successors still to calculate
+        bool unsatisfiable(const Knowledge* const, const Label_ID&) const;
+
+        /// whether the successor for a label is calculated later or is sane
+        inline bool mayResolve(const Knowledge* const, const Label_ID&, const Label_ID&) const;
+
         /// return the hash value of this object
         inline hash_t hash() const;
 
+        /// return the first byte of the marking block to hash and compare
+        inline const uint8_t* comparedBytes() const;
+
+        /// return whether this object stores the same markings as the given one
+        bool equals(const StoredKnowledge* const) const;
+
         /// move all transient markings to the end of the array and adjust size of the markings array
         inline void rearrangeKnowledgeBubble();
 
         /// adjust lowlink values of the stored knowledge
-        inline void adjustLowlinkValue(const StoredKnowledge* const, const bool) const;
+        inline void adjustLowlinkValue(const StoredKnowledge* const, const bool);
 
         /// evaluates the current knowledge bubble with respect to (T)SCCs
         void evaluateKnowledge();
@@ -165,6 +227,9 @@ class StoredKnowledge {
         /// print knowledge
         void print(std::ostream&) const;
 
+        /// the number of bytes occupied by this knowledge (including its arrays)
+        size_t memory() const;
+
         /// return a string representation of the knowledge's formula
         std::string formula(bool = false) const;
 
@@ -181,6 +246,15 @@ class StoredKnowledge {
         /// whether this bubble is still on the Tarjan stack
         unsigned is_on_tarjan_stack : 1;
 
+        /// the number of stored successors
+        unsigned successorCount : 8;
+
+        /// the depth-first number used for Tarjan's algorithm (0 if not yet visited)
+        unsigned int dfs;
+
+        /// the lowlink number used for Tarjan's algorithm
+        unsigned int lowlink;
+
     private: /* member attributes */
         /// \brief the number of markings stored in this knowledge
         innermarkingcount_t sizeDeadlockMarkings;
@@ -188,14 +262,18 @@ class StoredKnowledge {
         /// \brief the number of markings stored in this knowledge
         innermarkingcount_t sizeAllMarkings;
 
-        /// an array of inner markings (length is sizeAllMarkings)
-        InnerMarking_ID* inner;
-
         /// \brief an array of interface markings (length is sizeAllMarkings)
-        /// \todo Do we need an array to pointers here? Maybe explicit objects are enough.
-        InterfaceMarking** interface;
+        /// \note This array is the start of the marking block of this
+        ///       knowledge which also holds the inner markings and the words
+        ///       of the interface markings (see the constructor).
+        InterfaceMarking* interface;
+
+        /// an array of inner markings (length is sizeAllMarkings, stored in the marking block)
+        InnerMarking_ID* inner;
 
-        /// the successors of this knowledge (length is fixed by the labels)
+        /// \brief the successors of this knowledge, sorted by their labels
+        /// \note The block holds successorCount pointers followed by
+        ///       successorCount labels (see successorLabels()).
         StoredKnowledge** successors;
 
         /// contains for each label how many send messages are pending at least in the channels
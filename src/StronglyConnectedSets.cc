@@ -0,0 +1,343 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <algorithm>
+#include "StronglyConnectedSets.h"
+#include "StoredKnowledge.h"
+#include "Label.h"
+#include "util.h"
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+std::vector<StoredKnowledge*> StronglyConnectedSets::nodes;
+std::vector<unsigned int> StronglyConnectedSets::firstSuccessor;
+std::vector<unsigned int> StronglyConnectedSets::successors;
+std::vector<unsigned int> StronglyConnectedSets::firstPredecessor;
+std::vector<unsigned int> StronglyConnectedSets::predecessors;
+std::vector<unsigned int> StronglyConnectedSets::number;
+std::vector<unsigned int> StronglyConnectedSets::lowlink;
+size_t StronglyConnectedSets::words = 0;
+StronglyConnectedSets::Visitor StronglyConnectedSets::visitor = NULL;
+
+
+/// whether the knowledge with the given index is contained in a bitset
+#define CONTAINS(set, i) (((set)[(i) / 64] >> ((i) % 64)) & 1)
+
+/// adds the knowledge with the given index to a bitset
+#define INSERT(set, i) ((set)[(i) / 64] |= (1ULL << ((i) % 64)))
+
+/// removes the knowledge with the given index from a bitset
+#define REMOVE(set, i) ((set)[(i) / 64] &= ~(1ULL << ((i) % 64)))
+
+
+/****************************
+ * STATIC MEMBER FUNCTIONS *
+ ****************************/
+
+/*!
+ Numbers the knowledges by their position in the given set and stores their
+ edges (and the reversed edges) in arrays. Like in the search for the SCCs of
+ the operating guideline, only edges to sane knowledges are considered.
+*/
+void StronglyConnectedSets::initialize(const std::set<StoredKnowledge*>& knowledges) {
+    nodes.assign(knowledges.begin(), knowledges.end());
+    words = (nodes.size() + 63) / 64;
+
+    // collect the successors of each knowledge in the order of the labels
+    std::vector<unsigned int> inDegree(nodes.size() + 1, 0);
+    firstSuccessor.push_back(0);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (Label_ID l = Label::first_receive; l <= Label::last_sync; ++l) {
+            StoredKnowledge* const SK = nodes[i]->successor(l);
+            if (SK == NULL or SK == StoredKnowledge::empty or not SK->is_sane) {
+                continue;
+            }
+
+            // the knowledges are ordered by address
+            std::vector<StoredKnowledge*>::const_iterator pos = std::lower_bound(nodes.begin(), nodes.end(), SK);
+            if (pos != nodes.end() and *pos == SK) {
+                successors.push_back(pos - nodes.begin());
+                ++inDegree[pos - nodes.begin()];
+            }
+        }
+        firstSuccessor.push_back(successors.size());
+    }
+
+    // reverse the edges
+    firstPredecessor.assign(nodes.size() + 1, 0);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        firstPredecessor[i + 1] = firstPredecessor[i] + inDegree[i];
+    }
+    predecessors.resize(successors.size());
+    std::vector<unsigned int> position(firstPredecessor.begin(), firstPredecessor.end() - 1);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (unsigned int e = firstSuccessor[i]; e < firstSuccessor[i + 1]; ++e) {
+            predecessors[position[successors[e]]++] = i;
+        }
+    }
+
+    number.assign(nodes.size(), 0);
+    lowlink.assign(nodes.size(), 0);
+}
+
+
+void StronglyConnectedSets::finalize() {
+    std::vector<StoredKnowledge*>().swap(nodes);
+    std::vector<unsigned int>().swap(firstSuccessor);
+    std::vector<unsigned int>().swap(successors);
+    std::vector<unsigned int>().swap(firstPredecessor);
+    std::vector<unsigned int>().swap(predecessors);
+    std::vector<unsigned int>().swap(number);
+    std::vector<unsigned int>().swap(lowlink);
+}
+
+
+/*!
+ \param[in] knowledges  the knowledges whose SCSs are enumerated
+ \param[in] v           the function called for each SCS
+
+ \note The visitor may not call this function again.
+*/
+void StronglyConnectedSets::enumerate(const std::set<StoredKnowledge*>& knowledges, Visitor v) {
+    initialize(knowledges);
+    visitor = v;
+
+    // initially, no knowledge is fixed
+    NodeSet fixed(words, 0);
+    NodeSet nonFixed(words, 0);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        INSERT(nonFixed, i);
+    }
+
+    enumerate(fixed, nonFixed);
+
+    finalize();
+}
+
+
+/*!
+ \param[in] fixed     the knowledges every SCS must contain
+ \param[in] nonFixed  the knowledges an SCS may contain
+*/
+void StronglyConnectedSets::enumerate(const NodeSet& fixed, const NodeSet& nonFixed) {
+    NodeSet all(words);
+    bool noneFixed = true;
+    for (size_t k = 0; k < words; ++k) {
+        all[k] = fixed[k] | nonFixed[k];
+        noneFixed = noneFixed and fixed[k] == 0;
+    }
+
+    if (noneFixed) {
+        // every SCC is an SCS
+        std::vector<std::vector<unsigned int> > sccs;
+        components(all, sccs);
+
+        FOREACH(scc, sccs) {
+            NodeSet members(words, 0);
+            FOREACH(i, *scc) {
+                INSERT(members, *i);
+            }
+            process(members, fixed, nonFixed);
+        }
+    } else {
+        // only the SCC of the fixed knowledges can be an SCS
+        size_t first = 0;
+        while (not CONTAINS(fixed, first)) {
+            ++first;
+        }
+
+        NodeSet members(words, 0);
+        component(first, all, members);
+
+        for (size_t k = 0; k < words; ++k) {
+            if (fixed[k] & ~members[k]) {
+                return;
+            }
+        }
+        process(members, fixed, nonFixed);
+    }
+}
+
+
+/*!
+ Reports an SCS to the visitor. Then the SCSs strictly inside of it are
+ enumerated: the non-fixed knowledges of the SCS are removed one after
+ another, and each removed knowledge is fixed for the following ones.
+
+ \param[in] scs       the SCS
+ \param[in] fixed     the knowledges every SCS must contain
+ \param[in] nonFixed  the knowledges an SCS may contain
+*/
+void StronglyConnectedSets::process(const NodeSet& scs, const NodeSet& fixed, const NodeSet& nonFixed) {
+    std::set<StoredKnowledge*> knowledges;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (CONTAINS(scs, i)) {
+            knowledges.insert(knowledges.end(), nodes[i]);
+        }
+    }
+    visitor(knowledges);
+
+    NodeSet f(fixed);
+    NodeSet n(words);
+    for (size_t k = 0; k < words; ++k) {
+        n[k] = nonFixed[k] & scs[k];
+    }
+
+    const NodeSet intersection(n);
+    for (size_t k = 0; k < words; ++k) {
+        // skip words without non-fixed knowledges
+        for (size_t i = k * 64; intersection[k] and i < (k + 1) * 64 and i < nodes.size(); ++i) {
+            if (CONTAINS(intersection, i)) {
+                REMOVE(n, i);
+                enumerate(f, n);
+                INSERT(f, i);
+            }
+        }
+    }
+}
+
+
+/*!
+ Tarjan's algorithm on the given knowledges. The search starts with the
+ knowledges in the order of their indices and follows the edges in the order
+ of the labels.
+
+ \param[in]  all   the knowledges
+ \param[out] sccs  the SCCs in the order they are found; the members of each
+                   SCC are ordered by index
+*/
+void StronglyConnectedSets::components(const NodeSet& all, std::vector<std::vector<unsigned int> >& sccs) {
+    unsigned int counter = 0;
+    NodeSet onStack(words, 0);
+    std::vector<unsigned int> stack;
+    std::vector<unsigned int> visited;
+
+    // the search stack: a knowledge and the position of its next edge
+    std::vector<std::pair<unsigned int, unsigned int> > search;
+
+    for (size_t root = 0; root < nodes.size(); ++root) {
+        if (not CONTAINS(all, root) or number[root] != 0) {
+            continue;
+        }
+
+        number[root] = lowlink[root] = ++counter;
+        visited.push_back(root);
+        stack.push_back(root);
+        INSERT(onStack, root);
+        search.push_back(std::make_pair(root, firstSuccessor[root]));
+
+        while (not search.empty()) {
+            const unsigned int v = search.back().first;
+
+            // follow the next edge
+            if (search.back().second < firstSuccessor[v + 1]) {
+                const unsigned int w = successors[search.back().second++];
+
+                if (not CONTAINS(all, w)) {
+                    continue;
+                }
+
+                if (number[w] == 0) {
+                    number[w] = lowlink[w] = ++counter;
+                    visited.push_back(w);
+                    stack.push_back(w);
+                    INSERT(onStack, w);
+                    search.push_back(std::make_pair(w, firstSuccessor[w]));
+                } else if (CONTAINS(onStack, w)) {
+                    lowlink[v] = MINIMUM(lowlink[v], number[w]);
+                }
+                continue;
+            }
+
+            // all edges have been followed: the knowledge is finished
+            search.pop_back();
+
+            if (lowlink[v] == number[v]) {
+                std::vector<unsigned int> scc;
+                unsigned int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    REMOVE(onStack, w);
+                    scc.push_back(w);
+                } while (w != v);
+
+                std::sort(scc.begin(), scc.end());
+                sccs.push_back(scc);
+            }
+
+            if (not search.empty()) {
+                const unsigned int u = search.back().first;
+                lowlink[u] = MINIMUM(lowlink[u], lowlink[v]);
+            }
+        }
+    }
+
+    // reset the Tarjan values for the next call
+    FOREACH(v, visited) {
+        number[*v] = lowlink[*v] = 0;
+    }
+}
+
+
+/*!
+ \param[in]  knowledge  a knowledge
+ \param[in]  all        the knowledges (containing the given knowledge)
+ \param[out] scc        the knowledges of all that are reachable from and
+                        reach the given knowledge inside of all
+*/
+void StronglyConnectedSets::component(const unsigned int knowledge, const NodeSet& all, NodeSet& scc) {
+    std::vector<unsigned int> stack(1, knowledge);
+
+    // the knowledges reachable from the given knowledge
+    NodeSet forward(words, 0);
+    INSERT(forward, knowledge);
+    while (not stack.empty()) {
+        const unsigned int v = stack.back();
+        stack.pop_back();
+        for (unsigned int e = firstSuccessor[v]; e < firstSuccessor[v + 1]; ++e) {
+            const unsigned int w = successors[e];
+            if (CONTAINS(all, w) and not CONTAINS(forward, w)) {
+                INSERT(forward, w);
+                stack.push_back(w);
+            }
+        }
+    }
+
+    // the knowledges thereof reaching the given knowledge
+    scc.assign(words, 0);
+    INSERT(scc, knowledge);
+    stack.push_back(knowledge);
+    while (not stack.empty()) {
+        const unsigned int v = stack.back();
+        stack.pop_back();
+        for (unsigned int e = firstPredecessor[v]; e < firstPredecessor[v + 1]; ++e) {
+            const unsigned int w = predecessors[e];
+            if (CONTAINS(forward, w) and not CONTAINS(scc, w)) {
+                INSERT(scc, w);
+                stack.push_back(w);
+            }
+        }
+    }
+}
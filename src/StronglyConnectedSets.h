@@ -0,0 +1,108 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include <set>
+#include <vector>
+#include "types.h"
+
+
+class StoredKnowledge;
+
+
+/*!
+ \brief enumeration of the strongly connected sets of knowledges
+
+ A strongly connected set (SCS) is a set of knowledges that induces a
+ strongly connected subgraph. The sets are enumerated by fixing and removing
+ knowledges one after another: all SCSs that contain the fixed knowledges and
+ otherwise only non-fixed knowledges lie inside a single strongly connected
+ component (SCC) of the fixed and non-fixed knowledges.
+
+ The knowledges are numbered densely (in the order of their addresses, so
+ the sets are enumerated in the same order as by a search on the knowledges
+ themselves), their edges are stored in arrays, and sets of knowledges are
+ bitsets. As long as no knowledge is fixed, all SCCs are calculated with
+ Tarjan's algorithm. Otherwise, only the SCC of a fixed knowledge can
+ contain an SCS, and it is the intersection of the knowledges reachable
+ from and the knowledges reaching that knowledge.
+
+ \note This class is a static helper class from which no objects are built.
+*/
+class StronglyConnectedSets {
+    public: /* types */
+        /// the function that is called for each strongly connected set
+        typedef void (*Visitor)(const std::set<StoredKnowledge*>&);
+
+    private: /* types */
+        /// a set of knowledges given by their indices
+        typedef std::vector<uint64_t> NodeSet;
+
+    public: /* static functions */
+        /// calls the visitor for each strongly connected set of the given knowledges
+        static void enumerate(const std::set<StoredKnowledge*>&, Visitor);
+
+    private: /* static functions */
+        /// numbers the knowledges and collects their edges
+        static void initialize(const std::set<StoredKnowledge*>&);
+
+        /// release the memory used during the enumeration
+        static void finalize();
+
+        /// enumerates the SCSs containing all fixed and some non-fixed knowledges
+        static void enumerate(const NodeSet&, const NodeSet&);
+
+        /// reports an SCS and enumerates the SCSs inside of it
+        static void process(const NodeSet&, const NodeSet&, const NodeSet&);
+
+        /// calculates all SCCs of the given knowledges (Tarjan)
+        static void components(const NodeSet&, std::vector<std::vector<unsigned int> >&);
+
+        /// calculates the SCC of a knowledge inside the given knowledges
+        static void component(const unsigned int, const NodeSet&, NodeSet&);
+
+    private: /* static attributes */
+        /// the knowledges (ordered by address)
+        static std::vector<StoredKnowledge*> nodes;
+
+        /// the position of each knowledge's first successor (one more entry than knowledges)
+        static std::vector<unsigned int> firstSuccessor;
+
+        /// the successors of all knowledges
+        static std::vector<unsigned int> successors;
+
+        /// the position of each knowledge's first predecessor (one more entry than knowledges)
+        static std::vector<unsigned int> firstPredecessor;
+
+        /// the predecessors of all knowledges
+        static std::vector<unsigned int> predecessors;
+
+        /// the depth-first numbers of Tarjan's algorithm (0 for unvisited knowledges)
+        static std::vector<unsigned int> number;
+
+        /// the lowlink values of Tarjan's algorithm
+        static std::vector<unsigned int> lowlink;
+
+        /// the number of words of a bitset
+        static size_t words;
+
+        /// the function called for each strongly connected set
+        static Visitor visitor;
+};
@@ -0,0 +1,159 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#include <config.h>
+#include <algorithm>
+#include <set>
+#include <pnapi/pnapi.h>
+#include "StructuralReduction.h"
+#include "InnerMarking.h"
+#include "util.h"
+#include "verbose.h"
+
+
+/******************
+ * STATIC MEMBERS *
+ ******************/
+
+StructuralReduction::_stats StructuralReduction::stats = {0, 0, 0, 0, 0};
+
+
+/****************************
+ * STATIC MEMBER FUNCTIONS *
+ ****************************/
+
+/*!
+ \param[in] level  the level of rules to apply (see class description); 0
+                   leaves the net untouched
+
+ \note The rules are applied until none of them changes the net any more.
+*/
+void StructuralReduction::apply(const unsigned int& level) {
+    pnapi::PetriNet& net = *InnerMarking::net;
+
+    stats.level = level;
+    stats.places_before = stats.places_after = net.getPlaces().size();
+    stats.transitions_before = stats.transitions_after = net.getTransitions().size();
+
+    if (level == 0) {
+        return;
+    }
+
+    unsigned int rules = 0;
+    if (level >= 2) {
+        rules |= pnapi::PetriNet::IDENTICAL_PLACES | pnapi::PetriNet::IDENTICAL_TRANSITIONS;
+    }
+    if (level >= 3) {
+        rules |= pnapi::PetriNet::SERIES_PLACES | pnapi::PetriNet::SERIES_TRANSITIONS;
+    }
+
+    // the PN API applies its rules until they do not change the net, but
+    // merging nodes may create new dead nodes and vice versa
+    size_t size = 0;
+    while (size != net.getPlaces().size() + net.getTransitions().size()) {
+        size = net.getPlaces().size() + net.getTransitions().size();
+        removeDeadNodes();
+        if (rules != 0) {
+            net.reduce(rules);
+        }
+    }
+
+    stats.places_after = net.getPlaces().size();
+    stats.transitions_after = net.getTransitions().size();
+
+    status("structural reduction (level %d) removed %d places and %d transitions",
+        level, stats.places_before - stats.places_after,
+        stats.transitions_before - stats.transitions_after);
+}
+
+
+/*!
+ \return the number of removed nodes
+
+ \note Unlike the respective rule of the PN API, places occurring in the
+       final condition are kept, because removing them from the final
+       condition would change its meaning.
+*/
+unsigned int StructuralReduction::removeDeadNodes() {
+    pnapi::PetriNet& net = *InnerMarking::net;
+    const std::set<const pnapi::Place*> finalPlaces(net.getFinalCondition().getFormula().getPlaces());
+
+    unsigned int result = 0;
+    bool done = false;
+    while (not done) {
+        done = true;
+
+        std::set<pnapi::Place*> deadPlaces;
+        std::set<pnapi::Transition*> deadTransitions;
+
+        FOREACH(p, net.getPlaces()) {
+            // the tokens of the place can only be consumed by its postset
+            if (not std::includes((*p)->getPostset().begin(), (*p)->getPostset().end(),
+                                  (*p)->getPreset().begin(), (*p)->getPreset().end())) {
+                continue;
+            }
+
+            // no transition of the postset can ever consume these tokens
+            bool dead = not (*p)->getPostset().empty();
+            FOREACH(a, (*p)->getPostsetArcs()) {
+                if ((*a)->getWeight() <= (*p)->getTokenCount()) {
+                    dead = false;
+                    break;
+                }
+            }
+            if (not dead) {
+                continue;
+            }
+
+            FOREACH(t, (*p)->getPostset()) {
+                deadTransitions.insert(static_cast<pnapi::Transition*>(*t));
+            }
+            if (finalPlaces.find(*p) == finalPlaces.end()) {
+                deadPlaces.insert(*p);
+            }
+        }
+
+        FOREACH(t, deadTransitions) {
+            net.deleteTransition(**t);
+            ++result;
+            done = false;
+        }
+        FOREACH(p, deadPlaces) {
+            net.deletePlace(**p);
+            ++result;
+            done = false;
+        }
+    }
+
+    return result;
+}
+
+
+void StructuralReduction::output_results(Results& r) {
+    r.add("structural_reduction.level", stats.level);
+    r.add("structural_reduction.places_before", stats.places_before);
+    r.add("structural_reduction.places_after", stats.places_after);
+    r.add("structural_reduction.transitions_before", stats.transitions_before);
+    r.add("structural_reduction.transitions_after", stats.transitions_after);
+
+    // the inner markings before the reduction are not calculated; they are
+    // reported by a run with level 0
+    r.add("structural_reduction.inner_markings_after", InnerMarking::stats.markings);
+}
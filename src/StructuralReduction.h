@@ -0,0 +1,79 @@
+/*****************************************************************************\
+ Wendy -- Synthesizing Partners for Services
+
+ Copyright (c) 2009 Niels Lohmann, Christian Sura, and Daniela Weinberg
+
+ Wendy is free software: you can redistribute it and/or modify it under the
+ terms of the GNU Affero General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option)
+ any later version.
+
+ Wendy is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public License for
+ more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with Wendy.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#pragma once
+
+#include "Results.h"
+
+
+/*!
+ \brief structural reduction of the inner of the net
+
+ Before the reachability graph is calculated, the net can be reduced with
+ rules that change neither the behavior at the interface nor which markings
+ are final. The rules are grouped in levels, each level including the
+ previous ones:
+
+ 1. Structurally dead nodes: a place whose preset is contained in its
+    postset and which has fewer tokens than any of its outgoing arcs needs
+    never changes its marking, so the transitions of its postset can never
+    fire and are removed. The place itself is removed unless it occurs in
+    the final condition.
+
+ 2. Identical places and identical transitions (rules RB1 and RB2 of the
+    PN API): identical places always carry the same number of tokens, and
+    identical transitions must carry the same labels.
+
+ 3. Series places and series transitions (rules RA1 and RA2 of the PN API):
+    two transitions are merged if at most one of them is labeled and the
+    marking between them is transient and not final. This rule removes
+    inner markings.
+
+ \note This class is a static helper class from which no objects are built.
+*/
+class StructuralReduction {
+    public: /* static functions */
+        /// reduces InnerMarking::net with the rules up to the given level
+        static void apply(const unsigned int&);
+
+        /// add information for results output
+        static void output_results(Results&);
+
+    private: /* static functions */
+        /// removes structurally dead nodes
+        static unsigned int removeDeadNodes();
+
+    private: /* static attributes */
+        static struct _stats {
+            /// the applied level
+            unsigned int level;
+
+            /// the number of places before the reduction
+            unsigned int places_before;
+
+            /// the number of places after the reduction
+            unsigned int places_after;
+
+            /// the number of transitions before the reduction
+            unsigned int transitions_before;
+
+            /// the number of transitions after the reduction
+            unsigned int transitions_after;
+        } stats;
+};
@@ -22,7 +22,6 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
-#include <ctime>
 #include <libgen.h>
 #include <fstream>
 #include <sstream>
@@ -40,6 +39,11 @@
 #include "Clause.h"
 #include "verbose.h"
 #include "InternalReduction.h"
+#include "FinalCondition.h"
+#include "StructuralReduction.h"
+#include "StateSpace.h"
+#include "StateSpaceCache.h"
+#include "Statistics.h"
 
 
 // input files
@@ -61,9 +65,6 @@ std::string invocation;
 /// a file to store a mapping from marking ids to actual Petri net markings
 Output* markingoutput = NULL;
 
-/// a variable holding the time of the call
-clock_t start_clock = clock();
-
 
 /// replace one occurrence of a substring in a string
 std::string replaceOnce(std::string result, const std::string& replaceWhat,
@@ -162,6 +163,64 @@ void evaluateParameters(int argc, char** argv) {
         abort(8, "report frequency must not be negative");
     }
 
+    // the knowledges are only calculated partially when only deciding controllability
+    if (args_info.decideOnly_flag and (args_info.og_given or args_info.tg_given or args_info.sa_given or
+            args_info.dot_given or args_info.im_given or args_info.cover_given or args_info.diagnose_given or
+            args_info.correctness_arg == correctness_arg_livelock)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("livelock freedom or the output of the knowledges prevent only deciding controllability"));
+        args_info.decideOnly_flag = 0;
+    }
+
+    // check the number of threads
+    if (args_info.threads_arg < 1) {
+        abort(18, "number of threads must be positive");
+    }
+    if (args_info.threads_arg > 1 and (args_info.quitAsSoonAsPossible_flag or
+            args_info.succeedingSendingEvent_flag or args_info.decideOnly_flag or args_info.tg_given)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("reduction rules or test guidelines prevent using several threads"));
+        args_info.threads_arg = 1;
+    }
+
+    // check the limit of strongly connected sets
+    if (args_info.scsLimit_arg < 0) {
+        abort(19, "limit of strongly connected sets must not be negative");
+    }
+
+    // check the level of the structural reduction
+    if (args_info.structuralReduction_arg < 0 or args_info.structuralReduction_arg > 3) {
+        abort(20, "structural reduction level must be between 0 and 3");
+    }
+    if (args_info.structuralReduction_arg > 0 and args_info.cover_given) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("cover constraints prevent the structural reduction"));
+        args_info.structuralReduction_arg = 0;
+    }
+
+    // the markings are expanded on the fly only by the built-in generator and only for deadlock freedom
+    if (args_info.onTheFly_flag and (args_info.stateSpace_arg == stateSpace_arg_lola or args_info.internalReduction_flag or
+            args_info.mi_given or args_info.cover_given or args_info.diagnose_given or
+            args_info.correctness_arg == correctness_arg_livelock)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("LoLA, internal reduction, livelock freedom, marking information, cover, or diagnosis output prevent calculating the inner markings on the fly"));
+        args_info.onTheFly_flag = 0;
+    }
+    if (args_info.onTheFly_flag and (args_info.partialOrderReduction_flag or args_info.cache_given or args_info.threads_arg > 1)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("calculating the inner markings on the fly prevents the partial order reduction, the cache, and several threads"));
+        args_info.partialOrderReduction_flag = 0;
+        args_info.cache_given = 0;
+        args_info.threads_arg = 1;
+    }
+
+    // only the built-in generator reduces the reachability graph, and the cover needs all markings
+    if (args_info.partialOrderReduction_flag and (args_info.stateSpace_arg == stateSpace_arg_lola or args_info.cover_given)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("LoLA or cover constraints prevent the partial order reduction"));
+        args_info.partialOrderReduction_flag = 0;
+    }
+
+    // the cache does not contain the markings themselves
+    if (args_info.cache_given and (args_info.mi_given or args_info.cover_given or args_info.diagnose_given)) {
+        message("%s: %s", _cimportant_("warning"), _cwarning_("marking information, cover, or diagnosis output prevents using the cache"));
+        args_info.cache_given = 0;
+    }
+
     // check whether at most one file is given
     if (args_info.inputs_num > 1) {
         abort(4, "at most one input file must be given");
@@ -200,34 +259,24 @@ void evaluateParameters(int argc, char** argv) {
 /// a function collecting calls to organize termination (close files, ...)
 void terminationHandler() {
     // release memory (used to detect memory leaks)
+    // print statistics (before args_info is released)
+    const bool stats = args_info.stats_flag;
+
     if (args_info.finalize_flag) {
-        time_t start_time, end_time;
-        time(&start_time);
+        Statistics::startPhase("finalize");
         cmdline_parser_free(&args_info);
         InnerMarking::finalize();
         StoredKnowledge::finalize();
-
-        time(&end_time);
-        status("released memory [%.0f sec]", difftime(end_time, start_time));
+        status("released memory [%.2f sec]", Statistics::stopPhase());
     }
 
-    // print statistics
-    if (args_info.stats_flag) {
-        message("runtime: %s%.2f sec%s", _bold_, (static_cast<double>(clock()) - static_cast<double>(start_clock)) / CLOCKS_PER_SEC, _c_);
-        std::string call = std::string("ps -o rss -o comm | ") + TOOL_GREP + " " + PACKAGE + " | " + TOOL_AWK + " '{ if ($1 > max) max = $1 } END { print max \" KB\" }'";
-        FILE* ps = popen(call.c_str(), "r");
-        unsigned int memory;
-        int res = fscanf(ps, "%u", &memory);
-        assert(res != EOF);
-        pclose(ps);
-        message("memory consumption: %s%u KB %s", _bold_, memory, _c_);
+    if (stats) {
+        Statistics::print();
     }
 }
 
 
 int main(int argc, char** argv) {
-    time_t start_time, end_time;
-
     // set the function to call on normal termination
     atexit(terminationHandler);
 
@@ -245,6 +294,7 @@ int main(int argc, char** argv) {
     /*----------------------.
     | 1. parse the open net |
     `----------------------*/
+    Statistics::startPhase("parse");
     try {
         // parse either from standard input or from a given file
         if (args_info.inputs_num == 0) {
@@ -273,6 +323,9 @@ int main(int argc, char** argv) {
         abort(2, "\b%s", s.str().c_str());
     }
 
+    // reduce the net before it is checked and passed on
+    StructuralReduction::apply(args_info.structuralReduction_arg);
+
     // "fix" the net in order to avoid parse errors from LoLA (see bug #14166)
     if (InnerMarking::net->getTransitions().empty()) {
         status("net has no transitions -- adding dead dummy transition");
@@ -283,6 +336,7 @@ int main(int argc, char** argv) {
     if (not InnerMarking::net->isNormal()) {
         abort(3, "the input open net must be normal");
     }
+    status("parsed the open net [%.2f sec]", Statistics::stopPhase());
 
 
     /*--------------------------------------------.
@@ -291,12 +345,14 @@ int main(int argc, char** argv) {
     Label::initialize();
     InterfaceMarking::initialize();
     PossibleSendEvents::initialize();
+    FinalCondition::initialize();
 
 
     /*----------------------------.
     | 3. read cover file if given |
     `----------------------------*/
     if (args_info.cover_given) {
+        Statistics::startPhase("cover");
         if (args_info.cover_arg) {
             if (!(cover_in = fopen(args_info.cover_arg, "r"))) {
                 abort(15, "could not open cover file '%s'", args_info.cover_arg);
@@ -311,63 +367,76 @@ int main(int argc, char** argv) {
             status("covering all nodes");
         }
         status("%d nodes to cover", Cover::nodeCount);
+        Statistics::stopPhase();
     }
 
 
-    /*--------------------------------------------.
-    | 4. write inner of the open net to LoLA file |
-    `--------------------------------------------*/
-    Output* temp = new Output();
-    std::stringstream ss;
-//    ss << pnapi::io::lola << pnapi::io::formula << *InnerMarking::net;
-    ss << pnapi::io::lola << *InnerMarking::net;
-    std::string lola_net = ss.str();
-//    if (not Label::visible_transitions.empty()) {
-//        lola_net = replaceOnce(lola_net, "FORMULA", "FORMULA EXPATH (" + Label::visible_transitions + ") EVENTUALLY");
-//    }
-    temp->stream() << lola_net << std::endl;
-
-    // marking information output
+    /*---------------------------------------.
+    | 4. prepare marking information output |
+    `---------------------------------------*/
     if (args_info.mi_given) {
         std::string mi_filename = args_info.mi_arg ? args_info.mi_arg : filename + ".mi";
         markingoutput = new Output(mi_filename, "marking information");
     }
 
 
-    /*------------------------------------------.
-    | 5. call LoLA and parse reachability graph |
-    `------------------------------------------*/
-    // select LoLA binary and build LoLA command
+    /*------------------------------------.
+    | 5. calculate the reachability graph |
+    `------------------------------------*/
+    Statistics::startPhase("cache");
+    const bool cached = StateSpaceCache::load();
+    const double cacheSeconds = Statistics::stopPhase();
+    if (cached) {
+        status("read the reachability graph from the cache [%.2f sec]", cacheSeconds);
+    } else if (args_info.stateSpace_arg == stateSpace_arg_lola) {
+        // write inner of the open net to LoLA file
+        Output* temp = new Output();
+        std::stringstream ss;
+//        ss << pnapi::io::lola << pnapi::io::formula << *InnerMarking::net;
+        ss << pnapi::io::lola << *InnerMarking::net;
+        std::string lola_net = ss.str();
+//        if (not Label::visible_transitions.empty()) {
+//            lola_net = replaceOnce(lola_net, "FORMULA", "FORMULA EXPATH (" + Label::visible_transitions + ") EVENTUALLY");
+//        }
+        temp->stream() << lola_net << std::endl;
+
+        // select LoLA binary and build LoLA command
 #if defined(__MINGW32__)
-//    // MinGW does not understand pathnames with "/", so we use the basename
-    const std::string command_line = "\"" + std::string(args_info.lola_arg) + "\" " + temp->name() + " -M" + (args_info.verbose_flag ? "" : " 2> nul");
+//        // MinGW does not understand pathnames with "/", so we use the basename
+        const std::string command_line = "\"" + std::string(args_info.lola_arg) + "\" " + temp->name() + " -M" + (args_info.verbose_flag ? "" : " 2> nul");
 #else
-    const std::string command_line = std::string(args_info.lola_arg) + " " + temp->name() + " -M" + (args_info.verbose_flag ? "" : " 2> /dev/null");
+        const std::string command_line = std::string(args_info.lola_arg) + " " + temp->name() + " -M" + (args_info.verbose_flag ? "" : " 2> /dev/null");
 #endif
 
-    // call LoLA
-    status("calling %s: '%s'", _ctool_("LoLA"), command_line.c_str());
-    time(&start_time);
-    graph_in = popen(command_line.c_str(), "r");
+        // call LoLA
+        status("calling %s: '%s'", _ctool_("LoLA"), command_line.c_str());
+        Statistics::startPhase("lola");
+        graph_in = popen(command_line.c_str(), "r");
 
-    Output* temp2 = NULL;
-    if (args_info.internalReduction_flag) {
-        temp2 = Graph::internalReduction(graph_in);
-//        pclose(graph_in);
-        graph_in = fopen(temp2->name().c_str(), "r");
-    }
-
-    graph_parse();
-    if (args_info.internalReduction_flag) {
-        fclose(graph_in);
+        if (args_info.internalReduction_flag) {
+            Graph::internalReduction(graph_in);
+        } else {
+            graph_parse();
+            pclose(graph_in);
+            graph_lex_destroy();
+        }
+        status("%s%s is done [%.2f sec]", _ctool_("LoLA"), (args_info.internalReduction_flag ? " and internal reduction" : ""), Statistics::stopPhase());
+        delete temp;
+    } else if (args_info.onTheFly_flag) {
+        StateSpace::start();
+        status("calculating the reachability graph on the fly");
     } else {
-        pclose(graph_in);
+        status("calculating the reachability graph");
+        Statistics::startPhase("state_space");
+        if (args_info.internalReduction_flag) {
+            Graph::initialize();
+            StateSpace::calculate();
+            Graph::internalReduction();
+        } else {
+            StateSpace::calculate();
+        }
+        status("calculated %d inner markings%s [%.2f sec]", InnerMarking::markingMap.size(), (args_info.internalReduction_flag ? " after internal reduction" : ""), Statistics::stopPhase());
     }
-    graph_lex_destroy();
-    time(&end_time);
-    status("%s%s is done [%.0f sec]", _ctool_("LoLA"), (args_info.internalReduction_flag ? " and internal reduction" : ""), difftime(end_time, start_time));
-    delete temp;
-    delete temp2;
 
     // close marking information output file
     delete markingoutput;
@@ -376,31 +445,43 @@ int main(int argc, char** argv) {
     /*-------------------------------.
     | 6. organize reachability graph |
     `-------------------------------*/
+    Statistics::startPhase("organize");
     InnerMarking::initialize();
+    StateSpaceCache::store();
     Cover::clear();
+    status("organized the reachability graph [%.2f sec]", Statistics::stopPhase());
 
 
     /*-------------------------------.
     | 7. calculate knowledge bubbles |
     `-------------------------------*/
-    time(&start_time);
+    Statistics::startPhase("knowledges");
     Knowledge* K0 = new Knowledge(0);
     StoredKnowledge::root = new StoredKnowledge(K0);
 
     StoredKnowledge::root->store();
     if (StoredKnowledge::root->is_sane) {
-        StoredKnowledge::processNode(K0, StoredKnowledge::root);
+        if (args_info.threads_arg > 1) {
+            status("calculating knowledges using %d threads", args_info.threads_arg);
+            StoredKnowledge::processNodeParallel(K0, StoredKnowledge::root);
+        } else {
+            StoredKnowledge::processNode(K0, StoredKnowledge::root);
+        }
     }
     delete K0;
-    time(&end_time);
 
     // statistics output
-    status("stored %d knowledges, %d edges [%.0f sec]",
-           StoredKnowledge::stats.storedKnowledges, StoredKnowledge::stats.storedEdges, difftime(end_time, start_time));
+    status("stored %d knowledges, %d edges [%.2f sec]",
+           StoredKnowledge::stats.storedKnowledges, StoredKnowledge::stats.storedEdges, Statistics::stopPhase());
 
-    // traverse all nodes reachable from the root
-    StoredKnowledge::root->traverse();
-    status("%d knowledges reachable", StoredKnowledge::seen.size());
+    // traverse all nodes reachable from the root (not needed to decide controllability)
+    if (args_info.decideOnly_flag) {
+        status("decided controllability, skipped %d successors", StoredKnowledge::stats.skippedSuccessors);
+    } else {
+        Statistics::startPhase("traverse");
+        StoredKnowledge::root->traverse();
+        status("%d knowledges reachable [%.2f sec]", StoredKnowledge::seen.size(), Statistics::stopPhase());
+    }
 
     ///\todo rausfinden, was mit dot ist (kann ich eine LL-OG dotten)
     // in case of livelock freedom and if the operating guideline shall be
@@ -408,11 +489,10 @@ int main(int argc, char** argv) {
     if (args_info.correctness_arg == correctness_arg_livelock and args_info.og_given and
             (StoredKnowledge::root->is_sane or args_info.diagnose_given)) {
 
-        time(&start_time);
+        Statistics::startPhase("llog");
         LivelockOperatingGuideline::initialize();
         LivelockOperatingGuideline::generateLLOG();
-        time(&end_time);
-        status("generated LL-OG [%.0f sec]", difftime(end_time, start_time));
+        status("generated LL-OG [%.2f sec]", Statistics::stopPhase());
     }
 
     // analyze root node and print result
@@ -426,7 +506,9 @@ int main(int argc, char** argv) {
     | 8. calculate cover constraint |
     `--------------------------------*/
     if (args_info.cover_given) {
+        Statistics::startPhase("cover");
         Cover::calculate(StoredKnowledge::seen);
+        Statistics::stopPhase();
         message("%s: %s", _cimportant_("cover constraint is satisfiable"), (Cover::satisfiable ? _cgood_("YES") : _cbad_("NO")));
     }
 
@@ -434,35 +516,20 @@ int main(int argc, char** argv) {
     /*-------------------.
     | 9. output options |
     `-------------------*/
-    // results output
-    if (args_info.resultFile_given) {
-        std::string results_filename = args_info.resultFile_arg ? args_info.resultFile_arg : filename + ".results";
-        Results results(results_filename);
-        StoredKnowledge::output_results(results);
-        InnerMarking::output_results(results);
-        Label::output_results(results);
-
-        if (args_info.diagnose_given) {
-            Diagnosis::output_results(results);
-        }
-
-        results.add("meta.package_name", (const char*)PACKAGE_NAME);
-        results.add("meta.package_version", (const char*)PACKAGE_VERSION);
-        results.add("meta.svn_version", (const char*)VERSION_SVN);
-        results.add("meta.invocation", invocation);
-    }
-
     if (StoredKnowledge::root->is_sane or args_info.diagnose_given) {
 
     	// test guidelines output
     	if (args_info.tg_given) {
+    		Statistics::startPhase("output_tg");
     		std::string tg_filename = args_info.tg_arg ? args_info.tg_arg : filename + ".tg";
     		Output output(tg_filename, "test guidelines");
     		StoredKnowledge::output_og(output);
+    		Statistics::stopPhase();
     	}
 
         // operating guidelines output
         if (args_info.og_given) {
+            Statistics::startPhase("output_og");
             std::string og_filename = args_info.og_arg ? args_info.og_arg : filename + ".og";
             Output output(og_filename, "operating guidelines");
             StoredKnowledge::output_og(output);
@@ -472,6 +539,7 @@ int main(int argc, char** argv) {
                 Output cover_output(cover_filename, "cover constraint");
                 Cover::write(cover_output);
             }
+            Statistics::stopPhase();
 
             // print out some statistics gained by writing out the og file
             // (the decode() method of Clause is only called when we actually print out the annotations)
@@ -495,16 +563,20 @@ int main(int argc, char** argv) {
 
         // service automaton output
         if (args_info.sa_given) {
+            Statistics::startPhase("output_sa");
             std::string sa_filename = args_info.sa_arg ? args_info.sa_arg : filename + ".sa";
             Output output(sa_filename, "service automaton");
             StoredKnowledge::output_og(output);
+            Statistics::stopPhase();
         }
 
         // dot output
         if (args_info.dot_given) {
+            Statistics::startPhase("output_dot");
             std::string dot_filename = args_info.dot_arg ? args_info.dot_arg : filename + ".dot";
             Output output(dot_filename, "dot representation");
             StoredKnowledge::output_dot(output);
+            Statistics::stopPhase();
         }
 
         // migration output
@@ -512,19 +584,41 @@ int main(int argc, char** argv) {
             std::string im_filename = args_info.im_arg ? args_info.im_arg : filename + ".im";
             Output output(im_filename, "migration information");
 
-            time(&start_time);
+            Statistics::startPhase("output_im");
             StoredKnowledge::output_migration(output);
-            time(&end_time);
-            status("wrote migration information [%.0f sec]", difftime(end_time, start_time));
+            status("wrote migration information [%.2f sec]", Statistics::stopPhase());
         }
 
         // diagnose output
         if (args_info.diagnose_given) {
+            Statistics::startPhase("output_diagnosis");
             std::string diag_filename = args_info.diagnose_arg ? args_info.diagnose_arg : filename + ".diag.dot";
             Output output(diag_filename, "diagnosis information");
             Diagnosis::output_diagnosedot(output);
+            Statistics::stopPhase();
         }
     }
 
+    // results output (last, so the timing of all other outputs is included)
+    if (args_info.resultFile_given) {
+        std::string results_filename = args_info.resultFile_arg ? args_info.resultFile_arg : filename + ".results";
+        Results results(results_filename);
+        StoredKnowledge::output_results(results);
+        InnerMarking::output_results(results);
+        Label::output_results(results);
+        Statistics::output_results(results);
+        StateSpace::output_results(results);
+        StructuralReduction::output_results(results);
+
+        if (args_info.diagnose_given) {
+            Diagnosis::output_results(results);
+        }
+
+        results.add("meta.package_name", (const char*)PACKAGE_NAME);
+        results.add("meta.package_version", (const char*)PACKAGE_VERSION);
+        results.add("meta.svn_version", (const char*)VERSION_SVN);
+        results.add("meta.invocation", invocation);
+    }
+
     return EXIT_SUCCESS;
 }
@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "FinalCondition.h"
 #include "InnerMarking.h"
 #include "Label.h"
 #include "Output.h"
@@ -51,8 +52,12 @@ std::set<std::string> currentTransitions;
 /// the Tarjan lowlink value of the current marking
 InnerMarking_ID currentLowlink;
 
-/// a marking of the PN API net
-std::map<const pnapi::Place*, unsigned int> marking;
+/// the token counts of the current marking (indexed by FinalCondition::index();
+/// the last entry is never marked)
+std::vector<unsigned int> currentTokens;
+
+/// the indices of the places marked in the current marking
+std::vector<size_t> currentPlaces;
 
 /// storage for current (terminal) strongly connected component
 std::set<InnerMarking_ID> currentSCC;
@@ -85,8 +90,17 @@ states:
 state:
   KW_STATE NUMBER lowlink scc markings_or_transitions
     {
+        currentTokens.resize(FinalCondition::placeCount() + 1, 0);
         InnerMarking::markingMap[$2] = new InnerMarking($2, currentLabels, currentSuccessors,
-                                           InnerMarking::net->getFinalCondition().isSatisfied(pnapi::Marking(marking, InnerMarking::net)));
+                                           FinalCondition::satisfied(&currentTokens[0]));
+
+        // a PN API marking is only needed for the marking information and the cover
+        std::map<const pnapi::Place*, unsigned int> marking;
+        if (markingoutput or args_info.cover_given) {
+            FOREACH(p, currentPlaces) {
+                marking[FinalCondition::place(*p)] = currentTokens[*p];
+            }
+        }
 
         if (markingoutput) {
             markingoutput->stream() << $2 << ": ";
@@ -104,43 +118,15 @@ state:
             currentTransitions.clear();
         }
 
-        /* ================================================================================= */
-        /* calculate strongly connected components and do some evaluation on its members     */
-        /* ================================================================================= */
-
-        /* current marking is representative of an SCC and either reduction by smart sending events or correctness criteria livelock freedom is turned on */
-        if ((currentLowlink == $2 and not args_info.ignoreUnreceivedMessages_flag)
-            or args_info.correctness_arg == correctness_arg_livelock) {
-
-            // insert representative into current SCC of inner markings
-            currentSCC.insert($2);
-            
-            // we have found a non-trivial SCC within the inner markings, so the reachability graph
-            // contains a cycle
-            if (currentSCC.size() > 1) {
-                InnerMarking::is_acyclic = false;
-            }
-
-            // reduction by smart sending events is turned on
-            if (not args_info.ignoreUnreceivedMessages_flag) {
-                /* it is a trivial SCC */
-                if (currentSCC.size() == 1) {
-                    /* analyze only representative with respect to possible sending events */
-                    InnerMarking::markingMap[$2]->calcReachableSendingEvents();
-                } else {
-                    /* analyze all members of current SCC with respect to possible sending events and final markings reachable */
-                    InnerMarking::analyzeSCCOfInnerMarkings(currentSCC);
-                }
-            } else if (args_info.ignoreUnreceivedMessages_flag and args_info.correctness_arg == correctness_arg_livelock) {
-                // no smart sending event reduction but livelock freedom is turned on
-                InnerMarking::finalMarkingReachableSCC(currentSCC);
-            }
-        } /* end if, livelock freedom */
+        /* calculate strongly connected components and do some evaluation on its members */
+        InnerMarking::evaluateSCC($2, currentLowlink, currentSCC);
 
         currentLabels.clear();
         currentSuccessors.clear();
-        marking.clear();
-        currentSCC.clear();
+        FOREACH(p, currentPlaces) {
+            currentTokens[*p] = 0;
+        }
+        currentPlaces.clear();
    }
 ;
 
@@ -181,7 +167,16 @@ markings:
 
 marking:
   NAME COLON NUMBER
-    { marking[InnerMarking::net->findPlace($1)] = $3; free($1); }
+    {
+        const size_t p = FinalCondition::index($1);
+        if (p == FinalCondition::placeCount()) {
+            graph_error("unknown place");
+        }
+        currentTokens.resize(FinalCondition::placeCount() + 1, 0);
+        currentTokens[p] = $3;
+        currentPlaces.push_back(p);
+        free($1);
+    }
 ;
 
 transitions:
@@ -28,7 +28,8 @@
 
 
 %{
-#include <map>
+#include <vector>
+#include "FinalCondition.h"
 #include "InnerMarking.h"
 #include "InternalReduction.h"
 
@@ -37,8 +38,12 @@
 
 int currentState = 0;
 
-/// a marking of the PN API net
-std::map<const pnapi::Place*, unsigned int> __marking;
+/// the token counts of the current marking (indexed by FinalCondition::index();
+/// the last entry counts the tokens of unknown places)
+std::vector<unsigned int> __tokens;
+
+/// the indices of the places marked in the current marking
+std::vector<size_t> __places;
 
 extern int reducedgraph_lex();
 extern int reducedgraph_error(const char *);
@@ -62,11 +67,14 @@ states:
 state:
   KW_STATE NUMBER { currentState = $2; } prog lowlink scc
   markings {
-      const bool final = InnerMarking::net->getFinalCondition().isSatisfied(pnapi::Marking(__marking, InnerMarking::net));
-      if (final) {
+      __tokens.resize(FinalCondition::placeCount() + 1, 0);
+      if (FinalCondition::satisfied(&__tokens[0])) {
           Graph::g->addFinal(currentState);
       }
-      __marking.clear();
+      for (size_t i = 0; i < __places.size(); ++i) {
+          __tokens[__places[i]] = 0;
+      }
+      __places.clear();
   } transitions
 ;
 
@@ -95,7 +103,13 @@ markings:
 ;
 
 marking:
-  NAME COLON NUMBER { Graph::g->addMarking(currentState, $1, $3); __marking[InnerMarking::net->findPlace($1)] = $3; free($1); }
+  NAME COLON NUMBER {
+      Graph::g->addMarking(currentState, $1, $3);
+      __tokens.resize(FinalCondition::placeCount() + 1, 0);
+      __tokens[FinalCondition::index($1)] = $3;
+      __places.push_back(FinalCondition::index($1));
+      free($1);
+  }
 ;
 
 transitions:
@@ -24,8 +24,8 @@
 #include <stdint.h>
 #endif
 
-/// the range of hash values (max. 65535)
-typedef uint16_t hash_t;
+/// the range of hash values (64 bit)
+typedef uint64_t hash_t;
 
 /// the range of labels (max. 255)
 typedef uint8_t Label_ID;
@@ -0,0 +1,169 @@
+#!/bin/sh
+
+#============================================================================#
+# BENCHMARK SCRIPT                                                           #
+#============================================================================#
+
+# This script runs the benchmark cases of a case file (see "benchmark.cases")
+# several times and writes a report with one line per case. The numbers are
+# read from the results file of each run ("--resultFile"):
+#
+#   time_median, time_p90  median and 90th percentile of "timing.total" [sec]
+#   memory                 median of "memory.peak_rss" [KB]
+#   nodes, edges           "statistics.nodes" and "statistics.edges"
+#   scc_nontrivial         "statistics.scc_nontrivial"
+#   scc_maximal_size       "statistics.scc_maximal_size"
+#   result                 "controllability.result"
+#
+# If a baseline report is given, each case is compared to it. A case is
+# flagged if its median time or memory exceeds the baseline by more than the
+# tolerance, or if its nodes, edges, SCCs, or result differ. In this case,
+# the script exits with code 1.
+#
+# A net "netgen:FAMILY:N" is not read from the test files, but generated by
+# script "netgen.sh" with the given family and size.
+#
+# Usage: benchmark.sh WENDY TESTFILES CASES REPORT [BASELINE]
+#
+# Environment variables:
+#   REPEAT     number of runs per case (default: 5)
+#   TOLERANCE  allowed relative increase of time and memory (default: 0.2)
+#   CASE       only run cases whose name contains this string
+
+WENDY=$1
+TESTFILES=$2
+CASES=$3
+REPORT=$4
+BASELINE=$5
+
+REPEAT=${REPEAT:-5}
+TOLERANCE=${TOLERANCE:-0.2}
+AWK=${AWK:-awk}
+SHELL=${SHELL:-/bin/sh}
+NETGEN=`dirname $0`/netgen.sh
+
+if test -z "$REPORT"
+then
+  echo "usage: $0 WENDY TESTFILES CASES REPORT [BASELINE]" >&2
+  exit 2
+fi
+
+TMPDIR=`mktemp -d ${TMPDIR:-/tmp}/benchmark.XXXXXX` || exit 2
+trap 'rm -fr $TMPDIR' 0 1 2 15
+
+# read a value (part.name) from a results file
+value() {
+  $AWK -v part="$2" -v name="$3" '
+    $1 == part":" && $2 == "{" { inside = 1; next }
+    $1 == "};"                 { inside = 0; next }
+    inside && $1 == name       { sub(/;$/, "", $3); gsub(/"/, "", $3); print $3; exit }
+  ' $1
+}
+
+# print the p-th percentile (0..100) of the numbers in a file
+percentile() {
+  sort -n $1 | $AWK -v p=$2 '
+    { v[NR] = $1 }
+    END { i = int((NR - 1) * p / 100 + 0.5) + 1; print (NR ? v[i] : "-") }
+  '
+}
+
+echo "# case time_median time_p90 memory nodes edges scc_nontrivial scc_maximal_size result" > $REPORT
+
+grep -v '^#' $CASES | grep -v '^[ 	]*$' | while read NAME NET PARAMETERS
+do
+  case "$NAME" in
+    *"$CASE"*) ;;
+    *) continue ;;
+  esac
+
+  # nets "netgen:FAMILY:N" are generated with script "netgen.sh"
+  case "$NET" in
+    netgen:*)
+      FILE=$TMPDIR/`echo $NET | $AWK -F: '{ print $2 "-" $3 }'`.owfn
+      $SHELL $NETGEN `echo $NET | $AWK -F: '{ print $2, $3 }'` > $FILE || exit 2
+      ;;
+    *)
+      FILE=$TESTFILES/$NET
+      ;;
+  esac
+
+  rm -f $TMPDIR/time $TMPDIR/memory
+  RUN=1
+  FAILED=0
+  while test $RUN -le $REPEAT
+  do
+    if ! $WENDY $FILE $PARAMETERS --resultFile=$TMPDIR/results >/dev/null 2>&1
+    then
+      FAILED=1
+      break
+    fi
+    value $TMPDIR/results timing total >> $TMPDIR/time
+    value $TMPDIR/results memory peak_rss >> $TMPDIR/memory
+    RUN=`expr $RUN + 1`
+  done
+
+  if test $FAILED -eq 1
+  then
+    echo "$NAME: Wendy failed" >&2
+    echo "$NAME - - - - - - - failed" >> $REPORT
+    continue
+  fi
+
+  # the counts do not depend on the run, so the last results file is used
+  LINE="$NAME `percentile $TMPDIR/time 50` `percentile $TMPDIR/time 90` `percentile $TMPDIR/memory 50`"
+  for KEY in nodes edges scc_nontrivial scc_maximal_size
+  do
+    LINE="$LINE `value $TMPDIR/results statistics $KEY`"
+  done
+  LINE="$LINE `value $TMPDIR/results controllability result`"
+  echo "$LINE" >> $REPORT
+  echo "$LINE" | $AWK '{ printf "%-26s %10.3f sec %10d KB %10s nodes\n", $1, $2, $4, $5 }'
+done
+
+# compare the report to the baseline
+if test -z "$BASELINE"
+then
+  exit 0
+fi
+if test ! -f "$BASELINE"
+then
+  echo "no baseline '$BASELINE' found; call 'make benchmark-baseline' to create it"
+  exit 0
+fi
+
+$AWK -v tolerance=$TOLERANCE '
+  BEGIN { split("nodes edges scc_nontrivial scc_maximal_size result", column) }
+  FNR == 1 { file++ }
+  /^#/ { next }
+  file == 1 { for (i = 2; i <= NF; ++i) base[$1, i] = $i; known[$1] = 1; next }
+  {
+    if (not_first++ == 0) {
+      print ""
+    }
+    if (!($1 in known)) {
+      printf "%-26s no baseline\n", $1
+      next
+    }
+    message = ""
+    if ($2 > base[$1, 2] * (1 + tolerance) && $2 - base[$1, 2] > 0.01) {
+      message = message sprintf(" time %.3f -> %.3f sec", base[$1, 2], $2)
+    }
+    if ($4 > base[$1, 4] * (1 + tolerance)) {
+      message = message sprintf(" memory %d -> %d KB", base[$1, 4], $4)
+    }
+    for (i = 5; i <= 9; ++i) {
+      if ($i != base[$1, i]) {
+        message = message sprintf(" %s %s -> %s", column[i - 4], base[$1, i], $i)
+      }
+    }
+    if (message != "") {
+      printf "%-26s REGRESSION:%s\n", $1, message
+      regressions++
+    }
+  }
+  END {
+    printf "%d regression(s) compared to the baseline\n", regressions
+    exit (regressions > 0)
+  }
+' $BASELINE $REPORT
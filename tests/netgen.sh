@@ -0,0 +1,189 @@
+#!/bin/sh
+
+#============================================================================#
+# NET GENERATOR                                                              #
+#============================================================================#
+
+# This script writes a scalable open net to the standard output. Each family
+# is parameterized by a size n which allows to chart how the number of
+# knowledges, edges, time, and memory grow with n (see target
+# "benchmark-scaling" in the Makefile). The families are:
+#
+#   sequence      receives n messages in a fixed order (as sequence10.owfn)
+#   parallel      n independent channels, each receiving and then sending a
+#                 message; the number of knowledges grows exponentially in n
+#   philosophers  n dining philosophers that need a controller to avoid the
+#                 deadlock of all taking their left fork (as phcontrol3.owfn)
+#   choice        internally chooses one of n branches, announces it, and
+#                 waits for a matching answer
+#   scc           cycles through n internal states (an inner SCC of size n)
+#                 until it receives the message of the current state
+#
+# All nets are controllable for deadlock freedom and livelock freedom.
+#
+# Usage: netgen.sh FAMILY N
+
+FAMILY=$1
+N=$2
+
+case "$FAMILY" in
+  sequence|parallel|philosophers|choice|scc) ;;
+  *)
+    echo "usage: $0 sequence|parallel|philosophers|choice|scc N" >&2
+    exit 2
+    ;;
+esac
+
+case "$N" in
+  ''|*[!0-9]*) N=0 ;;
+esac
+if test "$N" -lt 1
+then
+  echo "$0: size must be a positive number" >&2
+  exit 2
+fi
+if test "$FAMILY" = philosophers && test "$N" -lt 2
+then
+  echo "$0: at least two philosophers are needed" >&2
+  exit 2
+fi
+
+${AWK:-awk} -v family=$FAMILY -v n=$N '
+# print a comma-separated list of the given names, one per line
+function list(names, count,    i) {
+  for (i = 1; i <= count; ++i) {
+    printf "  %s%s\n", names[i], (i < count ? "," : ";")
+  }
+  if (count == 0) {
+    print "  ;"
+  }
+}
+
+# print a transition; consume and produce are comma-separated place lists
+function transition(name, consume, produce,    c, p, i, count) {
+  printf "\nTRANSITION %s\nCONSUME\n", name
+  count = split(consume, c, ",")
+  for (i = 1; i <= count; ++i) {
+    printf "  %s: 1%s\n", c[i], (i < count ? "," : ";")
+  }
+  printf "PRODUCE\n"
+  count = split(produce, p, ",")
+  for (i = 1; i <= count; ++i) {
+    printf "  %s: 1%s\n", p[i], (i < count ? "," : ";")
+  }
+  if (count == 0) {
+    print "  ;"
+  }
+}
+
+# print the net header from the arrays internal, input, output, initial, and
+# final with the respective counts
+function header() {
+  printf "{ generated by netgen.sh: %s %d }\n\n", family, n
+  print "PLACE"
+  print "INTERNAL"
+  list(internal, internals)
+  print "INPUT"
+  list(input, inputs)
+  print "OUTPUT"
+  list(output, outputs)
+  print "\nINITIALMARKING"
+  list(initial, initials)
+  print "\nFINALMARKING"
+  list(final, finals)
+}
+
+BEGIN {
+  if (family == "sequence") {
+    for (i = 0; i <= n; ++i) internal[++internals] = "p" i
+    for (i = 1; i <= n; ++i) input[++inputs] = "a" i
+    initial[++initials] = "p0: 1"
+    final[++finals] = "p" n ": 1"
+    header()
+    for (i = 1; i <= n; ++i) {
+      transition("t" i, "p" (i - 1) ",a" i, "p" i)
+    }
+  }
+
+  if (family == "parallel") {
+    for (i = 1; i <= n; ++i) {
+      internal[++internals] = "start" i
+      internal[++internals] = "busy" i
+      internal[++internals] = "done" i
+      input[++inputs] = "a" i
+      output[++outputs] = "b" i
+      initial[++initials] = "start" i ": 1"
+      final[++finals] = "done" i ": 1"
+    }
+    header()
+    for (i = 1; i <= n; ++i) {
+      transition("receive" i, "start" i ",a" i, "busy" i)
+      transition("send" i, "busy" i, "done" i ",b" i)
+    }
+  }
+
+  if (family == "philosophers") {
+    # philosopher i thinks (th), holds the left fork (hl), eats (ea), and is
+    # ready afterwards; it shares fork i with its left and fork i+1 with its
+    # right neighbor; the controller tells it when to take the left fork
+    for (i = 1; i <= n; ++i) {
+      internal[++internals] = "th" i
+      internal[++internals] = "hl" i
+      internal[++internals] = "ea" i
+      internal[++internals] = "ready" i
+      internal[++internals] = "fo" i
+      input[++inputs] = "take" i
+      output[++outputs] = "eaten" i
+      initial[++initials] = "th" i ": 1"
+      initial[++initials] = "fo" i ": 1"
+    }
+    internal[++internals] = "end"
+    final[++finals] = "end: 1"
+    for (i = 1; i <= n; ++i) final[++finals] = "fo" i ": 1"
+    header()
+    for (i = 1; i <= n; ++i) {
+      right = (i % n) + 1
+      transition("takeLeft" i, "th" i ",fo" i ",take" i, "hl" i)
+      transition("takeRight" i, "hl" i ",fo" right, "ea" i ",eaten" i)
+      transition("release" i, "ea" i, "fo" i ",fo" right ",ready" i)
+    }
+    finish = "ready1"
+    for (i = 2; i <= n; ++i) finish = finish ",ready" i
+    transition("finish", finish, "end")
+  }
+
+  if (family == "choice") {
+    internal[++internals] = "start"
+    internal[++internals] = "end"
+    for (i = 1; i <= n; ++i) {
+      internal[++internals] = "chosen" i
+      internal[++internals] = "wait" i
+      input[++inputs] = "answer" i
+      output[++outputs] = "branch" i
+    }
+    initial[++initials] = "start: 1"
+    final[++finals] = "end: 1"
+    header()
+    for (i = 1; i <= n; ++i) {
+      transition("choose" i, "start", "chosen" i)
+      transition("announce" i, "chosen" i, "wait" i ",branch" i)
+      transition("receive" i, "wait" i ",answer" i, "end")
+    }
+  }
+
+  if (family == "scc") {
+    for (i = 1; i <= n; ++i) {
+      internal[++internals] = "state" i
+      input[++inputs] = "a" i
+    }
+    internal[++internals] = "end"
+    initial[++initials] = "state1: 1"
+    final[++finals] = "end: 1"
+    header()
+    for (i = 1; i <= n; ++i) {
+      transition("step" i, "state" i, "state" ((i % n) + 1))
+      transition("leave" i, "state" i ",a" i, "end")
+    }
+  }
+}
+'
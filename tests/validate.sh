@@ -0,0 +1,100 @@
+#!/bin/sh
+
+#============================================================================#
+# VALIDATION SCRIPT                                                          #
+#============================================================================#
+
+# This script runs each case of a case file (see "benchmark.cases") twice:
+# once as given and once with additional parameters that are meant not to
+# change the verdict, for instance "--partialOrderReduction". For each case,
+# it prints the result and the number of inner markings and knowledges of
+# both runs (read from "--resultFile").
+#
+# A case is flagged as MISMATCH if the results differ or if one of the runs
+# fails; the script then exits with code 1. Differing numbers of markings or
+# knowledges are expected from a reduction and are only reported.
+#
+# A net "netgen:FAMILY:N" is not read from the test files, but generated by
+# script "netgen.sh" with the given family and size.
+#
+# Usage: validate.sh WENDY TESTFILES CASES PARAMETERS...
+#
+# Environment variables:
+#   CASE       only run cases whose name contains this string
+
+WENDY=$1
+TESTFILES=$2
+CASES=$3
+
+if test $# -lt 4
+then
+  echo "usage: $0 WENDY TESTFILES CASES PARAMETERS..." >&2
+  exit 2
+fi
+shift 3
+VALIDATE="$*"
+
+AWK=${AWK:-awk}
+SHELL=${SHELL:-/bin/sh}
+NETGEN=`dirname $0`/netgen.sh
+
+TMPDIR=`mktemp -d ${TMPDIR:-/tmp}/validate.XXXXXX` || exit 2
+trap 'rm -fr $TMPDIR' 0 1 2 15
+
+# read a value (part.name) from a results file
+value() {
+  $AWK -v part="$2" -v name="$3" '
+    $1 == part":" && $2 == "{" { inside = 1; next }
+    $1 == "};"                 { inside = 0; next }
+    inside && $1 == name       { sub(/;$/, "", $3); gsub(/"/, "", $3); print $3; exit }
+  ' $1
+}
+
+grep -v '^#' $CASES | grep -v '^[ 	]*$' | while read NAME NET PARAMETERS
+do
+  case "$NAME" in
+    *"$CASE"*) ;;
+    *) continue ;;
+  esac
+
+  # nets "netgen:FAMILY:N" are generated with script "netgen.sh"
+  case "$NET" in
+    netgen:*)
+      FILE=$TMPDIR/`echo $NET | $AWK -F: '{ print $2 "-" $3 }'`.owfn
+      $SHELL $NETGEN `echo $NET | $AWK -F: '{ print $2, $3 }'` > $FILE || exit 2
+      ;;
+    *)
+      FILE=$TESTFILES/$NET
+      ;;
+  esac
+
+  rm -f $TMPDIR/original $TMPDIR/validated
+  $WENDY $FILE $PARAMETERS --resultFile=$TMPDIR/original >/dev/null 2>&1
+  $WENDY $FILE $PARAMETERS $VALIDATE --resultFile=$TMPDIR/validated >/dev/null 2>&1
+
+  if test ! -f $TMPDIR/original -o ! -f $TMPDIR/validated
+  then
+    printf "%-26s MISMATCH: Wendy failed\n" $NAME
+    echo x >> $TMPDIR/mismatches
+    continue
+  fi
+
+  RESULT=`value $TMPDIR/original controllability result`
+  printf "%-26s %-6s %10s -> %10s inner markings %8s -> %8s knowledges" $NAME $RESULT \
+    `value $TMPDIR/original statistics inner_markings` `value $TMPDIR/validated statistics inner_markings` \
+    `value $TMPDIR/original statistics nodes` `value $TMPDIR/validated statistics nodes`
+
+  if test "$RESULT" != "`value $TMPDIR/validated controllability result`"
+  then
+    printf "  MISMATCH: result %s -> %s" $RESULT `value $TMPDIR/validated controllability result`
+    echo x >> $TMPDIR/mismatches
+  fi
+  echo
+done
+
+if test -f $TMPDIR/mismatches
+then
+  echo "`wc -l < $TMPDIR/mismatches | tr -d ' '` mismatch(es) with parameters '$VALIDATE'"
+  exit 1
+fi
+echo "no mismatches with parameters '$VALIDATE'"